@@ -1,17 +1,22 @@
 #version 330 core
 
+// Shared crossed quad pair and the tile corner of each vertex
 layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec2 aTexCoord;
+layout (location = 1) in vec2 aCorner;
+// Per plant instance, block position in the chunk and atlas tile
+layout (location = 2) in vec3 aBlockPos;
+layout (location = 3) in vec2 aTile;
 
 out vec2 TexCoord;
 out vec3 Normal;
 uniform float texMultiplier;
-uniform mat4 model;
+// World position of the chunk the vertex belongs to
+uniform vec3 chunkOffset;
 uniform mat4 view;
 uniform mat4 projection;
 
 void main()
 {
-	gl_Position = projection * view * model * vec4(aPos, 1.0);
-	TexCoord = aTexCoord * texMultiplier;
+	gl_Position = projection * view * vec4(aPos + aBlockPos + chunkOffset, 1.0);
+	TexCoord = (aTile + aCorner) * texMultiplier;
 }
\ No newline at end of file
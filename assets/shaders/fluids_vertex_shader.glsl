@@ -9,7 +9,8 @@ out vec2 TexCoord;
 out vec3 Normal;
 
 uniform float texMultiplier;
-uniform mat4 model;
+// World position of the chunk the vertex belongs to
+uniform vec3 chunkOffset;
 uniform mat4 view;
 uniform mat4 projection;
 uniform float time;
@@ -39,7 +40,7 @@ void main()
 		pos.y += (sin(pos.x * 1.5708 + time) + sin(pos.z * 1.5708 + time * 1.5)) * 0.05;
 	}
 	
-	gl_Position = projection * view * model * vec4(pos, 1.0);
+	gl_Position = projection * view * vec4(pos + chunkOffset, 1.0);
 	
 	float frame = mod(time / animationTime, 1.0) * aFrames;
 	vec2 currentTex = aTexCoord;
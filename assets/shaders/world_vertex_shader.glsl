@@ -3,11 +3,14 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aTexCoord;
 layout (location = 2) in int aDirection;
+layout (location = 3) in int aLight;
 
 out vec2 TexCoord;
 out vec3 Normal;
+out float Light;
 uniform float texMultiplier;
-uniform mat4 model;
+// World position of the chunk the vertex belongs to
+uniform vec3 chunkOffset;
 uniform mat4 view;
 uniform mat4 projection;
 uniform float time;
@@ -24,7 +27,9 @@ vec3(0, -1, 0)// 6
 );
 void main()
 {
-	gl_Position = projection * view * model * vec4(aPos, 1.0);
+	gl_Position = projection * view * vec4(aPos + chunkOffset, 1.0);
 	TexCoord = aTexCoord * texMultiplier;
 	Normal = normals[aDirection];
+	// Keep unlit faces faintly visible
+	Light = max(aLight / 15.0, 0.1);
 }
\ No newline at end of file
@@ -1,6 +1,27 @@
+#include <cstdlib>
+#include <cstring>
 #include "headers/GameObject.h"
+#include "headers/WorldGenCheck.h"
+#include "headers/WorldEdit.h"
+
+int main(int argc, char** argv) {
+    // --check-worldgen [threads]: compare generated chunks with the golden fingerprints and exit
+    if (argc > 1 && strcmp(argv[1], "--check-worldgen") == 0) {
+        if (argc > 2)
+            return WorldGenCheck::run(atoi(argv[2])) ? 0 : 1;
+
+        bool passed = true;
+        for (unsigned int threads : {0u, 1u, 4u, 16u})
+            passed = WorldGenCheck::run(threads) && passed;
+        return passed ? 0 : 1;
+    }
+
+    // --bench-worldedit [size]: time bulk edits of a size^3 box and exit
+    if (argc > 1 && strcmp(argv[1], "--bench-worldedit") == 0) {
+        WorldEdit::runBenchmark(argc > 2 ? atoi(argv[2]) : 256);
+        return 0;
+    }
 
-int main() {
     GameObject& gObject = GameObject::getInstance(1280,720, "");
     gObject.init();
     return 0;
@@ -0,0 +1,9 @@
+#include "headers/Biome.h"
+
+Biome::Biome(float temperature, float humidity, float baseHeight, float heightScale,
+    unsigned int topBlock, unsigned int fillerBlock, std::vector<float> featureDensity, std::string biomeName)
+    : temperature(temperature), humidity(humidity), baseHeight(baseHeight), heightScale(heightScale),
+      topBlock(topBlock), fillerBlock(fillerBlock), featureDensity(featureDensity), biomeName(biomeName)
+{
+
+}
\ No newline at end of file
@@ -2,12 +2,35 @@
 
 #include <Shader.h>
 #include <GL/glew.h>
-#include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <cmath>
+#include <random>
 
 #include "../headers/Planet.h"
 #include "../headers/WorldGen.h"
 #include "../headers/Blocks.h"
+#include "../headers/Lighting.h"
+
+// Two quads crossing diagonally through the block cell, each vertex is a position and a corner of the tile
+static const float BILLBOARD_QUAD_VERTICES[] = {
+    .85355f, 0, .85355f, 0, 0,
+    .14645f, 0, .14645f, 1, 0,
+    .85355f, 1, .85355f, 0, 1,
+    .14645f, 1, .14645f, 1, 1,
+
+    .14645f, 0, .85355f, 0, 0,
+    .85355f, 0, .14645f, 1, 0,
+    .14645f, 1, .85355f, 0, 1,
+    .85355f, 1, .14645f, 1, 1,
+};
+static const unsigned int BILLBOARD_QUAD_INDICES[] = {
+    0, 3, 1, 0, 2, 3,
+    4, 7, 5, 4, 6, 7,
+};
+static constexpr unsigned int BILLBOARD_QUAD_INDEX_COUNT = sizeof(BILLBOARD_QUAD_INDICES) / sizeof(unsigned int);
+
+unsigned int Chunk::billboardQuadVBO = 0;
+unsigned int Chunk::billboardQuadEBO = 0;
 
 Chunk::Chunk(ChunkPos chunkPos, Shader *shader, Shader *waterShader)
     : chunkPos(chunkPos) {
@@ -30,25 +53,21 @@ Chunk::~Chunk() {
     glDeleteBuffers(1, &liquidEBO);
     glDeleteVertexArrays(1, &waterVAO);
 
-    glDeleteBuffers(1, &billboardVBO);
-    glDeleteBuffers(1, &billboardEBO);
+    glDeleteBuffers(1, &billboardInstanceVBO);
     glDeleteVertexArrays(1, &billboardVAO);
 }
 
 void Chunk::generateChunkMesh() {
     worldVertices.clear();
-    worldIndices.clear();
     liquidVertices.clear();
     liquidIndices.clear();
-    billboardVertices.clear();
-    billboardIndices.clear();
+    billboardInstances.clear();
     numTrianglesWorld = 0;
     numTrianglesLiquid = 0;
-    numTrianglesBillboard = 0;
+    numBillboards = 0;
 
     unsigned int currentVertex = 0;
     unsigned int currentLiquidVertex = 0;
-    unsigned int currentBillboardVertex = 0;
     for (char x = 0; x < CHUNK_SIZE; x++) {
         for (char z = 0; z < CHUNK_SIZE; z++) {
             for (char y = 0; y < CHUNK_SIZE; y++) {
@@ -58,26 +77,32 @@ void Chunk::generateChunkMesh() {
                 const Block *block = &Blocks::blocks[chunkData->getBlock(x, y, z)];
 
                 int topBlock;
+                char topLight;
                 if (y < CHUNK_SIZE - 1) {
                     topBlock = chunkData->getBlock(x, y + 1, z);
+                    topLight = chunkData->getLight(x, y + 1, z);
                 } else {
                     int blockIndex = x * CHUNK_SIZE * CHUNK_SIZE + z * CHUNK_SIZE + 0;
                     topBlock = upData->getBlock(x, 0, z);
+                    topLight = upData->getLight(x, 0, z);
                 }
 
                 const Block *topBlockType = &Blocks::blocks[topBlock];
                 char waterTopValue = topBlockType->blockType == Block::TRANSPARENT ? 1 : 0;
 
                 if (block->blockType == Block::BILLBOARD) {
-                    generateBillboardFaces(x, y, z, PLACEHOLDER_VALUE, block, currentBillboardVertex);
+                    generateBillboard(x, y, z, block);
                 } else {
                     // North
                     {
                         int northBlock;
+                        char northLight;
                         if (z > 0) {
                             northBlock = chunkData->getBlock(x, y, z - 1);
+                            northLight = chunkData->getLight(x, y, z - 1);
                         } else {
                             northBlock = northData->getBlock(x, y, CHUNK_SIZE - 1);
+                            northLight = northData->getLight(x, y, CHUNK_SIZE - 1);
                         }
 
                         const Block *northBlockType = &Blocks::blocks[northBlock];
@@ -89,7 +114,7 @@ void Chunk::generateChunkMesh() {
                             if (block->blockType == Block::LIQUID) {
                                 generateLiquidFaces(x, y, z, NORTH, block, currentLiquidVertex, waterTopValue);
                             } else {
-                                generateWorldFaces(x, y, z, NORTH, block, currentVertex);
+                                generateWorldFaces(x, y, z, NORTH, block, currentVertex, northLight);
                             }
                         }
                     }
@@ -97,10 +122,13 @@ void Chunk::generateChunkMesh() {
                     // South
                     {
                         int southBlock;
+                        char southLight;
                         if (z < CHUNK_SIZE - 1) {
                             southBlock = chunkData->getBlock(x, y, z + 1);
+                            southLight = chunkData->getLight(x, y, z + 1);
                         } else {
                             southBlock = southData->getBlock(x, y, 0);
+                            southLight = southData->getLight(x, y, 0);
                         }
 
                         const Block *southBlockType = &Blocks::blocks[southBlock];
@@ -112,7 +140,7 @@ void Chunk::generateChunkMesh() {
                             if (block->blockType == Block::LIQUID) {
                                 generateLiquidFaces(x, y, z, SOUTH, block, currentLiquidVertex, waterTopValue);
                             } else {
-                                generateWorldFaces(x, y, z, SOUTH, block, currentVertex);
+                                generateWorldFaces(x, y, z, SOUTH, block, currentVertex, southLight);
                             }
                         }
                     }
@@ -120,10 +148,13 @@ void Chunk::generateChunkMesh() {
                     // West
                     {
                         int westBlock;
+                        char westLight;
                         if (x > 0) {
                             westBlock = chunkData->getBlock(x - 1, y, z);
+                            westLight = chunkData->getLight(x - 1, y, z);
                         } else {
                             westBlock = westData->getBlock(CHUNK_SIZE - 1, y, z);
+                            westLight = westData->getLight(CHUNK_SIZE - 1, y, z);
                         }
 
                         const Block *westBlockType = &Blocks::blocks[westBlock];
@@ -135,7 +166,7 @@ void Chunk::generateChunkMesh() {
                             if (block->blockType == Block::LIQUID) {
                                 generateLiquidFaces(x, y, z, WEST, block, currentLiquidVertex, waterTopValue);
                             } else {
-                                generateWorldFaces(x, y, z, WEST, block, currentVertex);
+                                generateWorldFaces(x, y, z, WEST, block, currentVertex, westLight);
                             }
                         }
                     }
@@ -143,10 +174,13 @@ void Chunk::generateChunkMesh() {
                     // East
                     {
                         int eastBlock;
+                        char eastLight;
                         if (x < CHUNK_SIZE - 1) {
                             eastBlock = chunkData->getBlock(x + 1, y, z);
+                            eastLight = chunkData->getLight(x + 1, y, z);
                         } else {
                             eastBlock = eastData->getBlock(0, y, z);
+                            eastLight = eastData->getLight(0, y, z);
                         }
 
                         const Block *eastBlockType = &Blocks::blocks[eastBlock];
@@ -158,7 +192,7 @@ void Chunk::generateChunkMesh() {
                             if (block->blockType == Block::LIQUID) {
                                 generateLiquidFaces(x, y, z, EAST, block, currentLiquidVertex, waterTopValue);
                             } else {
-                                generateWorldFaces(x, y, z, EAST, block, currentVertex);
+                                generateWorldFaces(x, y, z, EAST, block, currentVertex, eastLight);
                             }
                         }
                     }
@@ -166,11 +200,14 @@ void Chunk::generateChunkMesh() {
                     // Bottom
                     {
                         int bottomBlock;
+                        char bottomLight;
                         if (y > 0) {
                             bottomBlock = chunkData->getBlock(x, y - 1, z);
+                            bottomLight = chunkData->getLight(x, y - 1, z);
                         } else {
                             //int blockIndex = x * chunkSize * chunkSize + z * chunkSize + (chunkSize - 1);
                             bottomBlock = downData->getBlock(x, CHUNK_SIZE - 1, z);
+                            bottomLight = downData->getLight(x, CHUNK_SIZE - 1, z);
                         }
 
                         const Block *bottomBlockType = &Blocks::blocks[bottomBlock];
@@ -182,7 +219,7 @@ void Chunk::generateChunkMesh() {
                             if (block->blockType == Block::LIQUID) {
                                 generateLiquidFaces(x, y, z, BOTTOM, block, currentLiquidVertex, waterTopValue);
                             } else {
-                                generateWorldFaces(x, y, z, BOTTOM, block, currentVertex);
+                                generateWorldFaces(x, y, z, BOTTOM, block, currentVertex, bottomLight);
                             }
                         }
                     }
@@ -197,7 +234,7 @@ void Chunk::generateChunkMesh() {
                                    || topBlockType->blockType == Block::TRANSPARENT
                                    || topBlockType->blockType == Block::BILLBOARD
                                    || topBlockType->blockType == Block::LIQUID) {
-                            generateWorldFaces(x, y, z, TOP, block, currentVertex);
+                            generateWorldFaces(x, y, z, TOP, block, currentVertex, topLight);
                         }
                     }
                 }
@@ -207,91 +244,100 @@ void Chunk::generateChunkMesh() {
 
     //std::cout << "Finished generating in thread: " << std::this_thread::get_id() << '\n';
 
+    groupWorldFaces();
+    chunkData->getSolidSlab(meshSolidBottom, meshSolidTop);
+    meshGroundHeight = chunkData->getGroundHeight();
+
+    // Seeded by the chunk position so a remesh keeps the same plants when thinned out
+    std::minstd_rand random((unsigned int) (chunkPos.x * 73856093 ^ chunkPos.y * 19349663 ^ chunkPos.z * 83492791));
+    std::shuffle(billboardInstances.begin(), billboardInstances.end(), random);
+
     generated = true;
 
     //std::cout << "Generated: " << generated << '\n';
 }
 
+// Reorders the world faces into one contiguous index range per FACE_DIRECTION, so the renderer can skip the
+// directions facing away from the camera
+void Chunk::groupWorldFaces() {
+    std::vector<WorldVertex> vertices;
+    vertices.reserve(worldVertices.size());
+
+    for (int direction = 0; direction < FACE_DIRECTION_COUNT; direction++) {
+        worldFaceStarts[direction] = vertices.size() / 4 * 6;
+        for (size_t quad = 0; quad < worldVertices.size(); quad += 4) {
+            if (worldVertices[quad].direction != direction)
+                continue;
+
+            for (int v = 0; v < 4; v++)
+                vertices.push_back(worldVertices[quad + v]);
+        }
+    }
+    worldFaceStarts[FACE_DIRECTION_COUNT] = vertices.size() / 4 * 6;
+    worldVertices.swap(vertices);
+
+    // Every face uses the same index pattern, so the indices are only built once the faces are in order
+    worldIndices.clear();
+    worldIndices.reserve(worldVertices.size() / 4 * 6);
+    for (unsigned int currentVertex = 0; currentVertex < worldVertices.size(); currentVertex += 4) {
+        worldIndices.push_back(currentVertex + 0);
+        worldIndices.push_back(currentVertex + 3);
+        worldIndices.push_back(currentVertex + 1);
+        worldIndices.push_back(currentVertex + 0);
+        worldIndices.push_back(currentVertex + 2);
+        worldIndices.push_back(currentVertex + 3);
+    }
+}
+
 void Chunk::generateWorldFaces(int x, int y, int z, FACE_DIRECTION faceDirection, const Block *block,
-                               unsigned int &currentVertex) {
+                               unsigned int &currentVertex, char light) {
     switch (faceDirection) {
         case NORTH: // North face
-            worldVertices.emplace_back(x + 1, y + 0, z + 0, block->sideMinX, block->sideMinY, 0);
-            worldVertices.emplace_back(x + 0, y + 0, z + 0, block->sideMaxX, block->sideMinY, 0);
-            worldVertices.emplace_back(x + 1, y + 1, z + 0, block->sideMinX, block->sideMaxY, 0);
-            worldVertices.emplace_back(x + 0, y + 1, z + 0, block->sideMaxX, block->sideMaxY, 0);
+            worldVertices.emplace_back(x + 1, y + 0, z + 0, block->sideMinX, block->sideMinY, 0, light);
+            worldVertices.emplace_back(x + 0, y + 0, z + 0, block->sideMaxX, block->sideMinY, 0, light);
+            worldVertices.emplace_back(x + 1, y + 1, z + 0, block->sideMinX, block->sideMaxY, 0, light);
+            worldVertices.emplace_back(x + 0, y + 1, z + 0, block->sideMaxX, block->sideMaxY, 0, light);
             break;
         case SOUTH: // South face
-            worldVertices.emplace_back(x + 0, y + 0, z + 1, block->sideMinX, block->sideMinY, 1);
-            worldVertices.emplace_back(x + 1, y + 0, z + 1, block->sideMaxX, block->sideMinY, 1);
-            worldVertices.emplace_back(x + 0, y + 1, z + 1, block->sideMinX, block->sideMaxY, 1);
-            worldVertices.emplace_back(x + 1, y + 1, z + 1, block->sideMaxX, block->sideMaxY, 1);
+            worldVertices.emplace_back(x + 0, y + 0, z + 1, block->sideMinX, block->sideMinY, 1, light);
+            worldVertices.emplace_back(x + 1, y + 0, z + 1, block->sideMaxX, block->sideMinY, 1, light);
+            worldVertices.emplace_back(x + 0, y + 1, z + 1, block->sideMinX, block->sideMaxY, 1, light);
+            worldVertices.emplace_back(x + 1, y + 1, z + 1, block->sideMaxX, block->sideMaxY, 1, light);
             break;
         case WEST: // West face
-            worldVertices.emplace_back(x + 0, y + 0, z + 0, block->sideMinX, block->sideMinY, 2);
-            worldVertices.emplace_back(x + 0, y + 0, z + 1, block->sideMaxX, block->sideMinY, 2);
-            worldVertices.emplace_back(x + 0, y + 1, z + 0, block->sideMinX, block->sideMaxY, 2);
-            worldVertices.emplace_back(x + 0, y + 1, z + 1, block->sideMaxX, block->sideMaxY, 2);
+            worldVertices.emplace_back(x + 0, y + 0, z + 0, block->sideMinX, block->sideMinY, 2, light);
+            worldVertices.emplace_back(x + 0, y + 0, z + 1, block->sideMaxX, block->sideMinY, 2, light);
+            worldVertices.emplace_back(x + 0, y + 1, z + 0, block->sideMinX, block->sideMaxY, 2, light);
+            worldVertices.emplace_back(x + 0, y + 1, z + 1, block->sideMaxX, block->sideMaxY, 2, light);
             break;
         case EAST: // East face
-            worldVertices.emplace_back(x + 1, y + 0, z + 1, block->sideMinX, block->sideMinY, 3);
-            worldVertices.emplace_back(x + 1, y + 0, z + 0, block->sideMaxX, block->sideMinY, 3);
-            worldVertices.emplace_back(x + 1, y + 1, z + 1, block->sideMinX, block->sideMaxY, 3);
-            worldVertices.emplace_back(x + 1, y + 1, z + 0, block->sideMaxX, block->sideMaxY, 3);
+            worldVertices.emplace_back(x + 1, y + 0, z + 1, block->sideMinX, block->sideMinY, 3, light);
+            worldVertices.emplace_back(x + 1, y + 0, z + 0, block->sideMaxX, block->sideMinY, 3, light);
+            worldVertices.emplace_back(x + 1, y + 1, z + 1, block->sideMinX, block->sideMaxY, 3, light);
+            worldVertices.emplace_back(x + 1, y + 1, z + 0, block->sideMaxX, block->sideMaxY, 3, light);
             break;
         case BOTTOM: //Bottom Face
-            worldVertices.emplace_back(x + 1, y + 0, z + 1, block->bottomMinX, block->bottomMinY, 4);
-            worldVertices.emplace_back(x + 0, y + 0, z + 1, block->bottomMaxX, block->bottomMinY, 4);
-            worldVertices.emplace_back(x + 1, y + 0, z + 0, block->bottomMinX, block->bottomMaxY, 4);
-            worldVertices.emplace_back(x + 0, y + 0, z + 0, block->bottomMaxX, block->bottomMaxY, 4);
+            worldVertices.emplace_back(x + 1, y + 0, z + 1, block->bottomMinX, block->bottomMinY, 4, light);
+            worldVertices.emplace_back(x + 0, y + 0, z + 1, block->bottomMaxX, block->bottomMinY, 4, light);
+            worldVertices.emplace_back(x + 1, y + 0, z + 0, block->bottomMinX, block->bottomMaxY, 4, light);
+            worldVertices.emplace_back(x + 0, y + 0, z + 0, block->bottomMaxX, block->bottomMaxY, 4, light);
             break;
         case TOP: //Top Face
-            worldVertices.emplace_back(x + 0, y + 1, z + 1, block->topMinX, block->topMinY, 5);
-            worldVertices.emplace_back(x + 1, y + 1, z + 1, block->topMaxX, block->topMinY, 5);
-            worldVertices.emplace_back(x + 0, y + 1, z + 0, block->topMinX, block->topMaxY, 5);
-            worldVertices.emplace_back(x + 1, y + 1, z + 0, block->topMaxX, block->topMaxY, 5);
+            worldVertices.emplace_back(x + 0, y + 1, z + 1, block->topMinX, block->topMinY, 5, light);
+            worldVertices.emplace_back(x + 1, y + 1, z + 1, block->topMaxX, block->topMinY, 5, light);
+            worldVertices.emplace_back(x + 0, y + 1, z + 0, block->topMinX, block->topMaxY, 5, light);
+            worldVertices.emplace_back(x + 1, y + 1, z + 0, block->topMaxX, block->topMaxY, 5, light);
             break;
         default: break;
     }
-    // Add indices for the face
-    worldIndices.push_back(currentVertex + 0);
-    worldIndices.push_back(currentVertex + 3);
-    worldIndices.push_back(currentVertex + 1);
-    worldIndices.push_back(currentVertex + 0);
-    worldIndices.push_back(currentVertex + 2);
-    worldIndices.push_back(currentVertex + 3);
+    // groupWorldFaces adds the indices once the faces are in their final order
 
     // Update currentVertex count
     currentVertex += 4;
 }
 
-void Chunk::generateBillboardFaces(int x, int y, int z, FACE_DIRECTION faceDirection, const Block *block,
-                                   unsigned int &currentVertex) {
-    billboardVertices.emplace_back(x + .85355f, y + 0, z + .85355f, block->sideMinX, block->sideMinY);
-    billboardVertices.emplace_back(x + .14645f, y + 0, z + .14645f, block->sideMaxX, block->sideMinY);
-    billboardVertices.emplace_back(x + .85355f, y + 1, z + .85355f, block->sideMinX, block->sideMaxY);
-    billboardVertices.emplace_back(x + .14645f, y + 1, z + .14645f, block->sideMaxX, block->sideMaxY);
-
-    billboardIndices.push_back(currentVertex + 0);
-    billboardIndices.push_back(currentVertex + 3);
-    billboardIndices.push_back(currentVertex + 1);
-    billboardIndices.push_back(currentVertex + 0);
-    billboardIndices.push_back(currentVertex + 2);
-    billboardIndices.push_back(currentVertex + 3);
-    currentVertex += 4;
-
-    billboardVertices.emplace_back(x + .14645f, y + 0, z + .85355f, block->sideMinX, block->sideMinY);
-    billboardVertices.emplace_back(x + .85355f, y + 0, z + .14645f, block->sideMaxX, block->sideMinY);
-    billboardVertices.emplace_back(x + .14645f, y + 1, z + .85355f, block->sideMinX, block->sideMaxY);
-    billboardVertices.emplace_back(x + .85355f, y + 1, z + .14645f, block->sideMaxX, block->sideMaxY);
-
-    billboardIndices.push_back(currentVertex + 0);
-    billboardIndices.push_back(currentVertex + 3);
-    billboardIndices.push_back(currentVertex + 1);
-    billboardIndices.push_back(currentVertex + 0);
-    billboardIndices.push_back(currentVertex + 2);
-    billboardIndices.push_back(currentVertex + 3);
-    currentVertex += 4;
+void Chunk::generateBillboard(int x, int y, int z, const Block *block) {
+    billboardInstances.emplace_back(x, y, z, block->sideMinX, block->sideMinY);
 }
 
 void Chunk::generateLiquidFaces(int x, int y, int z, FACE_DIRECTION faceDirection, const Block *block,
@@ -362,132 +408,99 @@ void Chunk::generateLiquidFaces(int x, int y, int z, FACE_DIRECTION faceDirectio
     currentVertex += 4;
 }
 
-void Chunk::render(Shader *mainShader, Shader *billboardShader) {
-    if (!ready) {
-        if (generated) {
-            // Solid
-            numTrianglesWorld = worldIndices.size();
-
-            glGenVertexArrays(1, &worldVAO);
-            glGenBuffers(1, &worldVBO);
-            glGenBuffers(1, &worldEBO);
-
-            glBindVertexArray(worldVAO);
-
-            glBindBuffer(GL_ARRAY_BUFFER, worldVBO);
-            glBufferData(GL_ARRAY_BUFFER, worldVertices.size() * sizeof(Vertex), worldVertices.data(), GL_STATIC_DRAW);
-
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, worldEBO);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, worldIndices.size() * sizeof(unsigned int), worldIndices.data(),
-                         GL_STATIC_DRAW);
-
-            glVertexAttribPointer(0, 3, GL_BYTE, GL_FALSE, sizeof(Vertex), (void *) offsetof(Vertex, posX));
-            glEnableVertexAttribArray(0);
-            glVertexAttribPointer(1, 2, GL_BYTE, GL_FALSE, sizeof(Vertex), (void *) offsetof(Vertex, texGridX));
-            glEnableVertexAttribArray(1);
-            glVertexAttribIPointer(2, 1, GL_BYTE, sizeof(Vertex), (void *) offsetof(Vertex, direction));
-            glEnableVertexAttribArray(2);
-
-            // Water
-            numTrianglesLiquid = liquidIndices.size();
-
-            glGenVertexArrays(1, &waterVAO);
-            glGenBuffers(1, &liquidVBO);
-            glGenBuffers(1, &liquidEBO);
-
-            glBindVertexArray(waterVAO);
-
-            glBindBuffer(GL_ARRAY_BUFFER, liquidVBO);
-            glBufferData(GL_ARRAY_BUFFER, liquidVertices.size() * sizeof(FluidVertex), liquidVertices.data(),
-                         GL_STATIC_DRAW);
-
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, liquidEBO);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, liquidIndices.size() * sizeof(unsigned int), liquidIndices.data(),
-                         GL_STATIC_DRAW);
-
-            glVertexAttribPointer(0, 3, GL_BYTE, GL_FALSE, sizeof(FluidVertex), (void *) offsetof(FluidVertex, posX));
-            glEnableVertexAttribArray(0);
-            glVertexAttribPointer(1, 2, GL_BYTE, GL_FALSE, sizeof(FluidVertex),
-                                  (void *) offsetof(FluidVertex, texGridX));
-            glEnableVertexAttribArray(1);
-            glVertexAttribIPointer(2, 1, GL_BYTE, sizeof(FluidVertex), (void *) offsetof(FluidVertex, direction));
-            glEnableVertexAttribArray(2);
-            glVertexAttribIPointer(3, 1, GL_BYTE, sizeof(FluidVertex), (void *) offsetof(FluidVertex, top));
-            glEnableVertexAttribArray(3);
-            ready = true;
-
-            // Billboard
-            numTrianglesBillboard = billboardIndices.size();
-
-            glGenVertexArrays(1, &billboardVAO);
-            glGenBuffers(1, &billboardVBO);
-            glGenBuffers(1, &billboardEBO);
-
-            glBindVertexArray(billboardVAO);
-
-            glBindBuffer(GL_ARRAY_BUFFER, billboardVBO);
-            glBufferData(GL_ARRAY_BUFFER, billboardVertices.size() * sizeof(BillboardVertex), billboardVertices.data(),
-                         GL_STATIC_DRAW);
-
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, billboardEBO);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, billboardIndices.size() * sizeof(unsigned int),
-                         billboardIndices.data(), GL_STATIC_DRAW);
-
-            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(BillboardVertex),
-                                  (void *) offsetof(BillboardVertex, posX));
-            glEnableVertexAttribArray(0);
-            glVertexAttribPointer(1, 2, GL_BYTE, GL_FALSE, sizeof(BillboardVertex),
-                                  (void *) offsetof(BillboardVertex, texGridX));
-            glEnableVertexAttribArray(1);
-            ready = true;
-        }
-
+void Chunk::queueDraws(RenderQueue &renderQueue, Shader *mainShader, Shader *billboardShader, Shader *waterShader,
+                       glm::vec3 cameraPos, float billboardDistance) {
+    if (!ready)
         return;
-    }
-
-    //std::cout << "Rendering chunk " << chunkPos.x << ", " << chunkPos.y << ", " << chunkPos.z << '\n'
-    //	<< "Chunk VAO: " << vertexArrayObject << '\n' << "Triangles: " << numTriangles << '\n';
 
-    // Calculate model matrix
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, worldPos);
+    glm::vec3 toCamera = cameraPos - (worldPos + glm::vec3(CHUNK_SIZE / 2.0f));
+    float distance = glm::dot(toCamera, toCamera);
+
+    // Far chunks never overlap their own water, the whole chunk is ordered against the others
+    if (numTrianglesLiquid > 0 && fabsf(toCamera.x) < CHUNK_SIZE * 1.5f && fabsf(toCamera.y) < CHUNK_SIZE * 1.5f &&
+        fabsf(toCamera.z) < CHUNK_SIZE * 1.5f)
+        sortWater(cameraPos);
+
+    // Faces on block sides the camera is behind for the whole chunk can't be seen, visible direction ranges
+    // next to each other are merged into one draw
+    glm::vec3 chunkMin = worldPos;
+    glm::vec3 chunkMax = worldPos + glm::vec3(CHUNK_SIZE);
+    bool visible[FACE_DIRECTION_COUNT];
+    visible[NORTH] = cameraPos.z < chunkMax.z - 1;
+    visible[SOUTH] = cameraPos.z > chunkMin.z + 1;
+    visible[WEST] = cameraPos.x < chunkMax.x - 1;
+    visible[EAST] = cameraPos.x > chunkMin.x + 1;
+    visible[BOTTOM] = cameraPos.y < chunkMax.y - 1;
+    visible[TOP] = cameraPos.y > chunkMin.y + 1;
+
+    for (int direction = 0; direction < FACE_DIRECTION_COUNT; ) {
+        if (!visible[direction]) {
+            direction++;
+            continue;
+        }
 
-    // Render main mesh
-    mainShader->use();
+        int last = direction;
+        while (last + 1 < FACE_DIRECTION_COUNT && visible[last + 1])
+            last++;
 
-    modelLoc = glGetUniformLocation(mainShader->program, "model");
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+        unsigned int first = uploadedFaceStarts[direction];
+        renderQueue.add(SOLID_PASS, mainShader, worldVAO, first, uploadedFaceStarts[last + 1] - first, worldPos, distance);
+        direction = last + 1;
+    }
 
-    glBindVertexArray(worldVAO);
-    glDrawElements(GL_TRIANGLES, numTrianglesWorld, GL_UNSIGNED_INT, 0);
+    // Meadows past billboardDistance cost nothing, closer in a growing share of the shuffled plants is drawn
+    float billboardFade = (billboardDistance - sqrtf(distance)) / (billboardDistance / 2.0f);
+    unsigned int billboards = (unsigned int) (numBillboards * std::clamp(billboardFade, 0.0f, 1.0f));
+    renderQueue.addInstanced(BILLBOARD_PASS, billboardShader, billboardVAO, BILLBOARD_QUAD_INDEX_COUNT, billboards, worldPos,
+                             distance);
+    renderQueue.add(WATER_PASS, waterShader, waterVAO, 0, numTrianglesLiquid, worldPos, distance);
+}
 
-    // Render billboard mesh
-    billboardShader->use();
+void Chunk::sortWater(glm::vec3 cameraPos) {
+    glm::ivec3 octant = glm::floor(cameraPos / (CHUNK_SIZE / 2.0f));
+    if (waterSorted && octant == waterSortOctant)
+        return;
 
-    modelLoc = glGetUniformLocation(billboardShader->program, "model");
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+    // Skip a frame rather than wait for a remesh, and leave a rebuilt mesh alone until its upload runs
+    if (!meshMutex.try_lock())
+        return;
+    if (meshUploadPending) {
+        meshMutex.unlock();
+        return;
+    }
 
-    glDisable(GL_CULL_FACE);
-    glBindVertexArray(billboardVAO);
-    glDrawElements(GL_TRIANGLES, numTrianglesBillboard, GL_UNSIGNED_INT, 0);
-    glEnable(GL_CULL_FACE);
-}
+    // Sort from the octant's center so the order holds until the camera leaves the octant
+    glm::vec3 eye = (glm::vec3(octant) + 0.5f) * (CHUNK_SIZE / 2.0f) - worldPos;
+
+    unsigned int quadCount = liquidIndices.size() / 6;
+    std::vector<std::pair<float, unsigned int>> quads(quadCount);
+    for (unsigned int i = 0; i < quadCount; i++) {
+        unsigned int firstVertex = liquidIndices[i * 6];
+        glm::vec3 center(0.0f);
+        for (unsigned int v = firstVertex; v < firstVertex + 4; v++)
+            center += glm::vec3(liquidVertices[v].posX, liquidVertices[v].posY, liquidVertices[v].posZ);
+        glm::vec3 toEye = center * 0.25f - eye;
+        quads[i] = {glm::dot(toEye, toEye), i};
+    }
 
-void Chunk::renderWater(Shader *shader) {
-    if (!ready)
-        return;
+    std::sort(quads.begin(), quads.end(), [](const std::pair<float, unsigned int> &a, const std::pair<float, unsigned int> &b) {
+        return a.first > b.first;
+    });
 
-    //std::cout << "Rendering chunk " << chunkPos.x << ", " << chunkPos.y << ", " << chunkPos.z << '\n'
-    //	<< "Chunk VAO: " << vertexArrayObject << '\n' << "Triangles: " << numTriangles << '\n';
+    sortedLiquidIndices.resize(liquidIndices.size());
+    for (unsigned int i = 0; i < quadCount; i++) {
+        for (unsigned int j = 0; j < 6; j++)
+            sortedLiquidIndices[i * 6 + j] = liquidIndices[quads[i].second * 6 + j];
+    }
+    meshMutex.unlock();
 
-    modelLoc = glGetUniformLocation(shader->program, "model");
+    // Same size as the uploaded indices, so the buffer is only overwritten
     glBindVertexArray(waterVAO);
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, sortedLiquidIndices.size() * sizeof(unsigned int), sortedLiquidIndices.data());
+    glBindVertexArray(0);
 
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, worldPos);
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-
-    glDrawElements(GL_TRIANGLES, numTrianglesLiquid, GL_UNSIGNED_INT, 0);
+    waterSortOctant = octant;
+    waterSorted = true;
 }
 
 uint16_t Chunk::getBlockAtPos(int x, int y, int z) {
@@ -499,46 +512,13 @@ uint16_t Chunk::getBlockAtPos(int x, int y, int z) {
 
 void Chunk::updateBlock(int x, int y, int z, uint16_t newBlock) {
     chunkData->setBlock(x, y, z, newBlock);
+    std::vector<ChunkPos> relitChunks;
+    Planet::planet->lightUpdateVoxels = Lighting::updateBlock(chunkPos, Planet::planet->getLightLookup(), x, y, z,
+                                                              relitChunks);
+    Planet::planet->fluidSimulation.blockChanged(chunkPos.x * (int) CHUNK_SIZE + x, chunkPos.y * (int) CHUNK_SIZE + y,
+                                                 chunkPos.z * (int) CHUNK_SIZE + z);
 
-    generateChunkMesh();
-
-    // Main
-    numTrianglesWorld = worldIndices.size();
-
-    glBindVertexArray(worldVAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, worldVBO);
-    glBufferData(GL_ARRAY_BUFFER, worldVertices.size() * sizeof(WorldVertex), worldVertices.data(), GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, worldEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, worldIndices.size() * sizeof(unsigned int), worldIndices.data(),
-                 GL_STATIC_DRAW);
-
-    // Water
-    numTrianglesLiquid = liquidIndices.size();
-
-    glBindVertexArray(waterVAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, liquidVBO);
-    glBufferData(GL_ARRAY_BUFFER, liquidVertices.size() * sizeof(FluidVertex), liquidVertices.data(), GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, liquidEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, liquidIndices.size() * sizeof(unsigned int), liquidIndices.data(),
-                 GL_STATIC_DRAW);
-
-    // Billboard
-    numTrianglesBillboard = billboardIndices.size();;
-
-    glBindVertexArray(billboardVAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, billboardVBO);
-    glBufferData(GL_ARRAY_BUFFER, billboardVertices.size() * sizeof(BillboardVertex), billboardVertices.data(),
-                 GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, billboardEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, billboardIndices.size() * sizeof(unsigned int), billboardIndices.data(),
-                 GL_STATIC_DRAW);
-
+    updateChunk();
 
     if (x == 0) {
         Chunk *westChunk = Planet::planet->getChunk({chunkPos.x - 1, chunkPos.y, chunkPos.z});
@@ -569,45 +549,145 @@ void Chunk::updateBlock(int x, int y, int z, uint16_t newBlock) {
         if (southChunk != nullptr)
             southChunk->updateChunk();
     }
+
+    // Chunks the light change spread into are rebuilt on the chunk thread
+    for (const ChunkPos &relitPos : relitChunks) {
+        if (!(relitPos == chunkPos))
+            Planet::planet->queueRemesh(relitPos);
+    }
 }
 
 void Chunk::updateChunk() {
+    meshMutex.lock();
     generateChunkMesh();
+    uploadMesh();
+    meshMutex.unlock();
+}
 
-    // Main
-    numTrianglesWorld = worldIndices.size();
+void Chunk::remesh() {
+    meshMutex.lock();
+    generateChunkMesh();
+    meshUploadPending = true;
+    meshMutex.unlock();
+}
 
-    glBindVertexArray(worldVAO);
+bool Chunk::tryUploadMesh() {
+    if (!meshMutex.try_lock())
+        return false;
 
-    glBindBuffer(GL_ARRAY_BUFFER, worldVBO);
-    glBufferData(GL_ARRAY_BUFFER, worldVertices.size() * sizeof(WorldVertex), worldVertices.data(), GL_STATIC_DRAW);
+    uploadMesh();
+    meshMutex.unlock();
+    return true;
+}
+
+// Replaces the buffer's contents, reallocating only when the data outgrew it
+static void uploadBuffer(GLenum target, unsigned int buffer, unsigned int &capacity, const void *data, size_t size) {
+    glBindBuffer(target, buffer);
+    if (size > capacity) {
+        glBufferData(target, size, data, GL_DYNAMIC_DRAW);
+        capacity = size;
+    } else if (size > 0) {
+        glBufferSubData(target, 0, size, data);
+    }
+}
+
+void Chunk::createBuffers() {
+    // Solid
+    glGenVertexArrays(1, &worldVAO);
+    glGenBuffers(1, &worldVBO);
+    glGenBuffers(1, &worldEBO);
 
+    glBindVertexArray(worldVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, worldVBO);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, worldEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, worldIndices.size() * sizeof(unsigned int), worldIndices.data(),
-                 GL_STATIC_DRAW);
+
+    glVertexAttribPointer(0, 3, GL_BYTE, GL_FALSE, sizeof(WorldVertex), (void *) offsetof(WorldVertex, posX));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_BYTE, GL_FALSE, sizeof(WorldVertex), (void *) offsetof(WorldVertex, texGridX));
+    glEnableVertexAttribArray(1);
+    glVertexAttribIPointer(2, 1, GL_BYTE, sizeof(WorldVertex), (void *) offsetof(WorldVertex, direction));
+    glEnableVertexAttribArray(2);
+    glVertexAttribIPointer(3, 1, GL_BYTE, sizeof(WorldVertex), (void *) offsetof(WorldVertex, light));
+    glEnableVertexAttribArray(3);
 
     // Water
-    numTrianglesLiquid = liquidIndices.size();
+    glGenVertexArrays(1, &waterVAO);
+    glGenBuffers(1, &liquidVBO);
+    glGenBuffers(1, &liquidEBO);
 
     glBindVertexArray(waterVAO);
-
     glBindBuffer(GL_ARRAY_BUFFER, liquidVBO);
-    glBufferData(GL_ARRAY_BUFFER, liquidVertices.size() * sizeof(FluidVertex), liquidVertices.data(), GL_STATIC_DRAW);
-
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, liquidEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, liquidIndices.size() * sizeof(unsigned int), liquidIndices.data(),
-                 GL_STATIC_DRAW);
+
+    glVertexAttribPointer(0, 3, GL_BYTE, GL_FALSE, sizeof(FluidVertex), (void *) offsetof(FluidVertex, posX));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_BYTE, GL_FALSE, sizeof(FluidVertex),
+                          (void *) offsetof(FluidVertex, texGridX));
+    glEnableVertexAttribArray(1);
+    glVertexAttribIPointer(2, 1, GL_BYTE, sizeof(FluidVertex), (void *) offsetof(FluidVertex, direction));
+    glEnableVertexAttribArray(2);
+    glVertexAttribIPointer(3, 1, GL_BYTE, sizeof(FluidVertex), (void *) offsetof(FluidVertex, top));
+    glEnableVertexAttribArray(3);
 
     // Billboard
-    numTrianglesBillboard = billboardIndices.size();
+    if (billboardQuadVBO == 0) {
+        glGenBuffers(1, &billboardQuadVBO);
+        glBindBuffer(GL_ARRAY_BUFFER, billboardQuadVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(BILLBOARD_QUAD_VERTICES), BILLBOARD_QUAD_VERTICES, GL_STATIC_DRAW);
+
+        glGenBuffers(1, &billboardQuadEBO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, billboardQuadEBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(BILLBOARD_QUAD_INDICES), BILLBOARD_QUAD_INDICES, GL_STATIC_DRAW);
+    }
+
+    glGenVertexArrays(1, &billboardVAO);
+    glGenBuffers(1, &billboardInstanceVBO);
 
     glBindVertexArray(billboardVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, billboardQuadVBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, billboardQuadEBO);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *) 0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *) (3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, billboardInstanceVBO);
+    glVertexAttribPointer(2, 3, GL_BYTE, GL_FALSE, sizeof(BillboardInstance), (void *) offsetof(BillboardInstance, posX));
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+    glVertexAttribPointer(3, 2, GL_BYTE, GL_FALSE, sizeof(BillboardInstance), (void *) offsetof(BillboardInstance, texGridX));
+    glEnableVertexAttribArray(3);
+    glVertexAttribDivisor(3, 1);
+}
 
-    glBindBuffer(GL_ARRAY_BUFFER, billboardVBO);
-    glBufferData(GL_ARRAY_BUFFER, billboardVertices.size() * sizeof(BillboardVertex), billboardVertices.data(),
-                 GL_STATIC_DRAW);
+void Chunk::uploadMesh() {
+    if (!ready)
+        createBuffers();
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, billboardEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, billboardIndices.size() * sizeof(unsigned int), billboardIndices.data(),
-                 GL_STATIC_DRAW);
-}
+    // The element buffer binding belongs to the vertex array, so bind that first
+    numTrianglesWorld = worldIndices.size();
+    std::copy(worldFaceStarts, worldFaceStarts + FACE_DIRECTION_COUNT + 1, uploadedFaceStarts);
+    solidBottom = meshSolidBottom;
+    solidTop = meshSolidTop;
+    groundHeight = meshGroundHeight;
+    glBindVertexArray(worldVAO);
+    uploadBuffer(GL_ARRAY_BUFFER, worldVBO, worldVBOSize, worldVertices.data(), worldVertices.size() * sizeof(WorldVertex));
+    uploadBuffer(GL_ELEMENT_ARRAY_BUFFER, worldEBO, worldEBOSize, worldIndices.data(), worldIndices.size() * sizeof(unsigned int));
+
+    numTrianglesLiquid = liquidIndices.size();
+    glBindVertexArray(waterVAO);
+    uploadBuffer(GL_ARRAY_BUFFER, liquidVBO, liquidVBOSize, liquidVertices.data(), liquidVertices.size() * sizeof(FluidVertex));
+    uploadBuffer(GL_ELEMENT_ARRAY_BUFFER, liquidEBO, liquidEBOSize, liquidIndices.data(), liquidIndices.size() * sizeof(unsigned int));
+
+    // The instance buffer is only referenced through the vertex array's attributes, no need to bind the array
+    numBillboards = billboardInstances.size();
+    uploadBuffer(GL_ARRAY_BUFFER, billboardInstanceVBO, billboardInstanceVBOSize, billboardInstances.data(),
+                 billboardInstances.size() * sizeof(BillboardInstance));
+
+    glBindVertexArray(0);
+    ready = true;
+    meshUploadPending = false;
+    // The new indices are in mesh order again
+    waterSorted = false;
+}
\ No newline at end of file
@@ -1,15 +1,19 @@
 #include "headers/ChunkData.h"
-#include "../headers/Planet.h"
+#include <algorithm>
+#include "../headers/RandomTicks.h"
+#include "../headers/Blocks.h"
 
 ChunkData::ChunkData(uint16_t* data)
     : data(data)
 {
-
+    light = new uint8_t[CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE]();
+    countTickable();
 }
 
 ChunkData::~ChunkData()
 {
     delete[] data;
+    delete[] light;
 }
 
 inline int ChunkData::getIndex(int x, int y, int z) const
@@ -34,5 +38,103 @@ uint16_t ChunkData::getBlock(int x, int y, int z)
 
 void ChunkData::setBlock(int x, int y, int z, uint16_t block)
 {
-    data[getIndex(x, y, z)] = block;
+    int index = getIndex(x, y, z);
+    tickableCounts[y / SECTION_HEIGHT] += RandomTicks::isTickable(block) - RandomTicks::isTickable(data[index]);
+    data[index] = block;
+    if (block != Blocks::WATER && !flowLevels.empty())
+        flowLevels.erase(index);
+}
+
+void ChunkData::countTickable()
+{
+    for (int section = 0; section < SECTION_COUNT; section++)
+        tickableCounts[section] = 0;
+
+    for (int x = 0; x < (int)CHUNK_SIZE; x++) {
+        for (int z = 0; z < (int)CHUNK_SIZE; z++) {
+            for (int y = 0; y < (int)CHUNK_SIZE; y++) {
+                if (RandomTicks::isTickable(data[getIndex(x, y, z)]))
+                    tickableCounts[y / SECTION_HEIGHT]++;
+            }
+        }
+    }
+}
+
+uint8_t ChunkData::getFlowLevel(int x, int y, int z)
+{
+    if (flowLevels.empty())
+        return 0;
+
+    auto it = flowLevels.find(getIndex(x, y, z));
+    return it == flowLevels.end() ? 0 : it->second;
+}
+
+void ChunkData::setFlowLevel(int x, int y, int z, uint8_t level)
+{
+    if (level == 0)
+        flowLevels.erase(getIndex(x, y, z));
+    else
+        flowLevels[getIndex(x, y, z)] = level;
+}
+
+uint8_t ChunkData::getSkyLight(int x, int y, int z)
+{
+    return light[getIndex(x, y, z)] >> 4;
+}
+
+uint8_t ChunkData::getBlockLight(int x, int y, int z)
+{
+    return light[getIndex(x, y, z)] & 0x0F;
+}
+
+uint8_t ChunkData::getLight(int x, int y, int z)
+{
+    uint8_t value = light[getIndex(x, y, z)];
+    return (value >> 4) > (value & 0x0F) ? (value >> 4) : (value & 0x0F);
+}
+
+void ChunkData::getSolidSlab(int& bottom, int& top)
+{
+    bool opaque[CHUNK_SIZE];
+    for (int y = 0; y < (int)CHUNK_SIZE; y++)
+        opaque[y] = true;
+
+    for (int x = 0; x < (int)CHUNK_SIZE; x++) {
+        for (int z = 0; z < (int)CHUNK_SIZE; z++) {
+            const uint16_t* column = &data[getIndex(x, 0, z)];
+            for (int y = 0; y < (int)CHUNK_SIZE; y++) {
+                if (Blocks::blocks[column[y]].blockType != Block::SOLID)
+                    opaque[y] = false;
+            }
+        }
+    }
+
+    bottom = 0;
+    top = 0;
+    int start = 0;
+    for (int y = 0; y <= (int)CHUNK_SIZE; y++) {
+        if (y < (int)CHUNK_SIZE && opaque[y])
+            continue;
+
+        if (y - start > top - bottom) {
+            bottom = start;
+            top = y;
+        }
+        start = y + 1;
+    }
+}
+
+int ChunkData::getGroundHeight()
+{
+    int ground = CHUNK_SIZE;
+    for (int x = 0; x < (int)CHUNK_SIZE && ground > 0; x++) {
+        for (int z = 0; z < (int)CHUNK_SIZE && ground > 0; z++) {
+            const uint16_t* column = &data[getIndex(x, 0, z)];
+            int y = CHUNK_SIZE;
+            while (y > 0 && Blocks::blocks[column[y - 1]].blockType != Block::SOLID)
+                y--;
+            ground = std::min(ground, y);
+        }
+    }
+    return ground;
 }
\ No newline at end of file
@@ -2,12 +2,15 @@
 
 #include <Shader.h>
 #include <thread>
+#include <mutex>
+#include <atomic>
 #include <vector>
 #include <glm/glm.hpp>
 #include "../Vertices/WorldVertex.h"
 #include "../Vertices/FluidVertex.h"
-#include "../Vertices/BillboardVertex.h""
+#include "../Vertices/BillboardInstance.h"
 #include "../headers/Block.h"
+#include "../headers/RenderQueue.h"
 #include "ChunkPos.h"
 #include "ChunkData.h"
 
@@ -18,14 +21,22 @@ public:
     ~Chunk();
 
     void generateChunkMesh();
-    void generateWorldFaces(int x, int y, int z, FACE_DIRECTION faceDirection, const Block *block, unsigned int &currentVertex);
-    void generateBillboardFaces(int x, int y, int z, FACE_DIRECTION faceDirection, const Block *block, unsigned int &currentVertex);
+    void groupWorldFaces();
+    void generateWorldFaces(int x, int y, int z, FACE_DIRECTION faceDirection, const Block *block, unsigned int &currentVertex, char light);
+    void generateBillboard(int x, int y, int z, const Block *block);
     void generateLiquidFaces(int x, int y, int z, FACE_DIRECTION faceDirection, const Block *block, unsigned int &currentVertex, char liquidTopValue);
-    void render(Shader* mainShader, Shader* billboardShader);
-    void renderWater(Shader* shader);
+    // Adds the chunk's solid, billboard and water draws, once its mesh is uploaded. Plants thin out from half of
+    // billboardDistance (in blocks) on and are gone past it
+    void queueDraws(RenderQueue& renderQueue, Shader* mainShader, Shader* billboardShader, Shader* waterShader, glm::vec3 cameraPos,
+                    float billboardDistance);
     uint16_t getBlockAtPos(int x, int y, int z);
     void updateBlock(int x, int y, int z, uint16_t newBlock);
     void updateChunk();
+    // Rebuilds the mesh off the render thread, tryUploadMesh uploads it
+    void remesh();
+    // Render thread only. Uploads the current mesh, creating the GL objects the first time, false if the mesh
+    // is being rebuilt right now
+    bool tryUploadMesh();
 
 public:
     ChunkData* chunkData;
@@ -38,20 +49,46 @@ public:
     ChunkPos chunkPos;
     bool ready;
     bool generated;
+    // Set while a job is remeshing, the chunk must not be deleted meanwhile
+    bool remeshing = false;
+    // ChunkData::getSolidSlab of the data the uploaded mesh was built from, the chunk's occluder
+    int solidBottom = 0, solidTop = 0;
+    // ChunkData::getGroundHeight of the same data, for horizon culling
+    int groundHeight = 0;
 
 private:
+    void createBuffers();
+    // Orders the water quads back to front for a camera in or next to the chunk, render thread only
+    void sortWater(glm::vec3 cameraPos);
+    // Called with meshMutex held
+    void uploadMesh();
+
     glm::vec3 worldPos;
+    std::mutex meshMutex;
     std::thread chunkThread;
 
     std::vector<WorldVertex> worldVertices;
     std::vector<unsigned int> worldIndices;
+    // First world index of each FACE_DIRECTION's faces, and the end of the last, in the generated and the uploaded mesh
+    unsigned int worldFaceStarts[FACE_DIRECTION_COUNT + 1] = {};
+    unsigned int uploadedFaceStarts[FACE_DIRECTION_COUNT + 1] = {};
+    int meshSolidBottom = 0, meshSolidTop = 0, meshGroundHeight = 0;
     std::vector<FluidVertex> liquidVertices;
     std::vector<unsigned int> liquidIndices;
-    std::vector<BillboardVertex> billboardVertices;
-    std::vector<unsigned int> billboardIndices;
+    // Uploaded water index order and the camera octant (CHUNK_SIZE / 2 cells) it was sorted for
+    std::vector<unsigned int> sortedLiquidIndices;
+    glm::ivec3 waterSortOctant;
+    bool waterSorted = false;
+    // The mesh was rebuilt and differs from what is in the buffers, guarded by meshMutex
+    bool meshUploadPending = false;
+    // In a shuffled order, so any prefix is an even thinning of the chunk's plants
+    std::vector<BillboardInstance> billboardInstances;
 
-    unsigned int worldVAO, waterVAO, billboardVAO;
-    unsigned int worldVBO, worldEBO, liquidVBO, liquidEBO, billboardVBO, billboardEBO;
-    unsigned int numTrianglesWorld, numTrianglesLiquid, numTrianglesBillboard;
-    unsigned int modelLoc;
+    unsigned int worldVAO = 0, waterVAO = 0, billboardVAO = 0;
+    unsigned int worldVBO = 0, worldEBO = 0, liquidVBO = 0, liquidEBO = 0, billboardInstanceVBO = 0;
+    // Allocated bytes of each buffer
+    unsigned int worldVBOSize = 0, worldEBOSize = 0, liquidVBOSize = 0, liquidEBOSize = 0, billboardInstanceVBOSize = 0;
+    unsigned int numTrianglesWorld, numTrianglesLiquid, numBillboards;
+    // The crossed quad pair every plant instance draws, shared by all chunks
+    static unsigned int billboardQuadVBO, billboardQuadEBO;
 };
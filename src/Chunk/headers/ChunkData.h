@@ -1,12 +1,25 @@
 #pragma once
 
 #include <cstdint>
+#include <unordered_map>
 #include "ChunkPos.h"
 
+constexpr unsigned int CHUNK_SIZE = 32;
+
+// Random ticks sample chunks in horizontal sections this many blocks tall
+constexpr int SECTION_HEIGHT = 8;
+constexpr int SECTION_COUNT = CHUNK_SIZE / SECTION_HEIGHT;
 
 struct ChunkData
 {
     uint16_t* data;
+    // Sky light in the high nibble, block light in the low nibble, indexed like data
+    uint8_t* light;
+    // Random-tickable blocks in each section, kept up to date by setBlock
+    uint16_t tickableCounts[SECTION_COUNT];
+    // Flow level of flowing water by index, source water has no entry. Saved with the blocks, setBlock drops the
+    // entry when the water is replaced.
+    std::unordered_map<uint16_t, uint8_t> flowLevels;
 
 
     ChunkData(uint16_t* data);
@@ -18,4 +31,20 @@ struct ChunkData
     uint16_t getBlock(ChunkPos blockPos);
     uint16_t getBlock(int x, int y, int z);
     void setBlock(int x, int y, int z, uint16_t block);
+    // Counts tickableCounts again, for when data was overwritten without setBlock
+    void countTickable();
+
+    // 0 for source water and anything that isn't water
+    uint8_t getFlowLevel(int x, int y, int z);
+    void setFlowLevel(int x, int y, int z, uint8_t level);
+
+    uint8_t getSkyLight(int x, int y, int z);
+    uint8_t getBlockLight(int x, int y, int z);
+    // Brightest of the sky and block light
+    uint8_t getLight(int x, int y, int z);
+
+    // Thickest run of layers [bottom, top) opaque in every column, it hides what is behind it. Empty if none is.
+    void getSolidSlab(int& bottom, int& top);
+    // Lowest height over every column of the top of its highest opaque block, 0 if a column has none
+    int getGroundHeight();
 };
\ No newline at end of file
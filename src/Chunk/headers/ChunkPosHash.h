@@ -1,3 +1,5 @@
+#pragma once
+
 #include "ChunkPos.h"
 #include <unordered_map>
 
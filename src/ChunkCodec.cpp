@@ -0,0 +1,184 @@
+#include "headers/ChunkCodec.h"
+
+#include <algorithm>
+
+#include "Chunk/headers/ChunkData.h"
+
+static const size_t blockCount = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
+
+static void writeU16(std::vector<uint8_t>& out, uint16_t value)
+{
+	out.push_back(value & 0xFF);
+	out.push_back(value >> 8);
+}
+
+static void writeVarint(std::vector<uint8_t>& out, uint32_t value)
+{
+	while (value >= 0x80)
+	{
+		out.push_back((value & 0x7F) | 0x80);
+		value >>= 7;
+	}
+	out.push_back(value);
+}
+
+static size_t varintSize(uint32_t value)
+{
+	size_t size = 1;
+	while (value >= 0x80)
+	{
+		value >>= 7;
+		size++;
+	}
+	return size;
+}
+
+static bool readVarint(const uint8_t*& bytes, const uint8_t* end, uint32_t& value)
+{
+	value = 0;
+	for (int shift = 0; shift < 35 && bytes < end; shift += 7)
+	{
+		uint8_t byte = *bytes++;
+		value |= (uint32_t)(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0)
+			return true;
+	}
+	return false;
+}
+
+void ChunkCodec::encode(const uint16_t* blocks, std::vector<uint8_t>& out)
+{
+	// Palette in order of first appearance
+	uint16_t maxBlock = *std::max_element(blocks, blocks + blockCount);
+	std::vector<int> paletteIndex(maxBlock + 1, -1);
+	std::vector<uint16_t> palette;
+
+	size_t runs = 0;
+	size_t runBytes = 0;
+	for (size_t i = 0; i < blockCount; )
+	{
+		uint16_t block = blocks[i];
+		if (paletteIndex[block] < 0)
+		{
+			paletteIndex[block] = palette.size();
+			palette.push_back(block);
+		}
+
+		size_t runEnd = i + 1;
+		while (runEnd < blockCount && blocks[runEnd] == block)
+			runEnd++;
+
+		runs++;
+		runBytes += varintSize(runEnd - i) + varintSize(paletteIndex[block]);
+		i = runEnd;
+	}
+
+	int bits = 1;
+	while ((1u << bits) < palette.size())
+		bits++;
+	size_t packedBytes = (blockCount * bits + 7) / 8;
+
+	ENCODING encoding = palette.size() == 1 ? SINGLE : runBytes < packedBytes ? RUNS : PACKED;
+	out.push_back(encoding);
+	writeU16(out, palette.size());
+	for (uint16_t block : palette)
+		writeU16(out, block);
+
+	if (encoding == RUNS)
+	{
+		out.reserve(out.size() + runBytes);
+		for (size_t i = 0; i < blockCount; )
+		{
+			uint16_t block = blocks[i];
+			size_t runEnd = i + 1;
+			while (runEnd < blockCount && blocks[runEnd] == block)
+				runEnd++;
+
+			writeVarint(out, runEnd - i);
+			writeVarint(out, paletteIndex[block]);
+			i = runEnd;
+		}
+	}
+	else if (encoding == PACKED)
+	{
+		// Indices packed low bit first, they may straddle bytes
+		size_t start = out.size();
+		out.resize(start + packedBytes, 0);
+		uint8_t* packed = out.data() + start;
+
+		size_t bit = 0;
+		for (size_t i = 0; i < blockCount; i++)
+		{
+			uint32_t index = paletteIndex[blocks[i]];
+			for (int b = 0; b < bits; b++, bit++)
+				packed[bit >> 3] |= ((index >> b) & 1) << (bit & 7);
+		}
+	}
+}
+
+size_t ChunkCodec::decode(const uint8_t* bytes, size_t size, uint16_t* blocks)
+{
+	const uint8_t* start = bytes;
+	const uint8_t* end = bytes + size;
+	if (size < 3)
+		return 0;
+
+	uint8_t encoding = bytes[0];
+	size_t paletteSize = bytes[1] | (bytes[2] << 8);
+	bytes += 3;
+	if (paletteSize == 0 || (size_t)(end - bytes) < paletteSize * 2)
+		return 0;
+
+	// Read the palette where it lies, it's only little endian pairs
+	const uint8_t* palette = bytes;
+	bytes += paletteSize * 2;
+	auto paletteBlock = [palette](size_t index) { return (uint16_t)(palette[index * 2] | (palette[index * 2 + 1] << 8)); };
+
+	if (encoding == SINGLE)
+	{
+		std::fill_n(blocks, blockCount, paletteBlock(0));
+	}
+	else if (encoding == RUNS)
+	{
+		size_t i = 0;
+		while (i < blockCount)
+		{
+			uint32_t length, index;
+			if (!readVarint(bytes, end, length) || !readVarint(bytes, end, index) ||
+				length == 0 || length > blockCount - i || index >= paletteSize)
+				return 0;
+
+			std::fill_n(blocks + i, length, paletteBlock(index));
+			i += length;
+		}
+	}
+	else if (encoding == PACKED)
+	{
+		int bits = 1;
+		while ((1u << bits) < paletteSize)
+			bits++;
+
+		size_t packedBytes = (blockCount * bits + 7) / 8;
+		if ((size_t)(end - bytes) < packedBytes)
+			return 0;
+
+		size_t bit = 0;
+		for (size_t i = 0; i < blockCount; i++)
+		{
+			uint32_t index = 0;
+			for (int b = 0; b < bits; b++, bit++)
+				index |= ((bytes[bit >> 3] >> (bit & 7)) & 1) << b;
+
+			if (index >= paletteSize)
+				return 0;
+			blocks[i] = paletteBlock(index);
+		}
+		bytes += packedBytes;
+	}
+	else
+	{
+		return 0;
+	}
+
+	return bytes - start;
+}
\ No newline at end of file
@@ -0,0 +1,196 @@
+#include "headers/ChunkResidency.h"
+
+#include <algorithm>
+#include <climits>
+
+void ChunkResidency::setRange(int distance, int height)
+{
+	if (distance == this->distance && height == this->height)
+		return;
+
+	for (auto& it : observers)
+		addArea(it.second, distance, height);
+	for (auto& it : observers)
+		removeArea(it.second, this->distance, this->height);
+
+	this->distance = distance;
+	this->height = height;
+	pendingSorted = false;
+}
+
+void ChunkResidency::setObserver(int id, ChunkPos center)
+{
+	auto it = observers.find(id);
+	if (it != observers.end() && it->second == center)
+		return;
+
+	addArea(center, distance, height);
+	if (it != observers.end())
+		removeArea(it->second, distance, height);
+
+	observers[id] = center;
+	pendingSorted = false;
+}
+
+void ChunkResidency::removeObserver(int id)
+{
+	auto it = observers.find(id);
+	if (it == observers.end())
+		return;
+
+	removeArea(it->second, distance, height);
+	observers.erase(it);
+	pendingSorted = false;
+}
+
+bool ChunkResidency::isResident(ChunkPos chunkPos) const
+{
+	auto it = chunks.find(chunkPos);
+	return it != chunks.end() && it->second.observers > 0;
+}
+
+bool ChunkResidency::nextToLoad(ChunkPos& chunkPos)
+{
+	if (!pendingSorted)
+		sortPending();
+
+	while (!pending.empty())
+	{
+		chunkPos = pending.back();
+		pending.pop_back();
+
+		// Skip chunks that were released or handed out since they were queued
+		auto it = chunks.find(chunkPos);
+		if (it == chunks.end() || it->second.state != PENDING)
+			continue;
+
+		it->second.state = LOADING;
+		pendingCount--;
+		return true;
+	}
+
+	return false;
+}
+
+bool ChunkResidency::setLoaded(ChunkPos chunkPos)
+{
+	auto it = chunks.find(chunkPos);
+	if (it == chunks.end())
+		return false;
+
+	if (it->second.state == PENDING)
+		pendingCount--;
+
+	// Every observer left while it was loading
+	if (it->second.observers == 0)
+	{
+		chunks.erase(it);
+		return false;
+	}
+
+	it->second.state = LOADED;
+	return true;
+}
+
+void ChunkResidency::takeReleased(std::vector<ChunkPos>& out)
+{
+	out.insert(out.end(), released.begin(), released.end());
+	released.clear();
+}
+
+bool ChunkResidency::hasPending() const
+{
+	return pendingCount > 0;
+}
+
+unsigned int ChunkResidency::getPendingCount() const
+{
+	return pendingCount;
+}
+
+unsigned int ChunkResidency::getResidentCount() const
+{
+	return chunks.size();
+}
+
+// Private
+void ChunkResidency::addArea(ChunkPos center, int distance, int height)
+{
+	for (int x = -distance; x <= distance; x++)
+	{
+		for (int z = -distance; z <= distance; z++)
+		{
+			for (int y = -height; y <= height; y++)
+			{
+				ChunkPos chunkPos(center.x + x, center.y + y, center.z + z);
+				Residency& residency = chunks[chunkPos];
+				residency.observers++;
+
+				if (residency.observers == 1 && residency.state == PENDING)
+				{
+					pending.push_back(chunkPos);
+					pendingCount++;
+				}
+			}
+		}
+	}
+}
+
+void ChunkResidency::removeArea(ChunkPos center, int distance, int height)
+{
+	for (int x = -distance; x <= distance; x++)
+	{
+		for (int z = -distance; z <= distance; z++)
+		{
+			for (int y = -height; y <= height; y++)
+			{
+				ChunkPos chunkPos(center.x + x, center.y + y, center.z + z);
+				auto it = chunks.find(chunkPos);
+				if (it == chunks.end() || --it->second.observers > 0)
+					continue;
+
+				// A chunk still loading keeps its entry so it isn't handed out twice, setLoaded drops it
+				if (it->second.state == LOADING)
+					continue;
+
+				if (it->second.state == LOADED)
+					released.push_back(chunkPos);
+				else
+					pendingCount--;
+				chunks.erase(it);
+			}
+		}
+	}
+}
+
+// Drops stale entries and orders the rest by distance to the nearest observer, nearest last
+void ChunkResidency::sortPending()
+{
+	std::vector<std::pair<int, ChunkPos>> sorted;
+	for (const ChunkPos& chunkPos : pending)
+	{
+		auto it = chunks.find(chunkPos);
+		if (it == chunks.end() || it->second.state != PENDING)
+			continue;
+
+		int nearest = INT_MAX;
+		for (auto& observer : observers)
+		{
+			int x = chunkPos.x - observer.second.x;
+			int y = chunkPos.y - observer.second.y;
+			int z = chunkPos.z - observer.second.z;
+			nearest = std::min(nearest, x * x + y * y + z * z);
+		}
+		sorted.emplace_back(nearest, chunkPos);
+	}
+
+	std::sort(sorted.begin(), sorted.end(), [](const std::pair<int, ChunkPos>& a, const std::pair<int, ChunkPos>& b)
+	{
+		return a.first > b.first;
+	});
+
+	pending.clear();
+	for (auto& it : sorted)
+		pending.push_back(it.second);
+	pendingSorted = true;
+}
\ No newline at end of file
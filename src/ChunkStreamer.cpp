@@ -0,0 +1,172 @@
+#include "headers/ChunkStreamer.h"
+
+static const std::vector<ChunkPos> chunkOffsets = { { 0, 0, 0 } };
+static const std::vector<ChunkPos> neighbourOffsets = { { 0, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, -1 }, { 0, 0, 1 }, { 1, 0, 0 }, { -1, 0, 0 } };
+
+ChunkStreamer::ChunkStreamer(JobSystem& jobSystem, std::mutex& mutex, LoadFunction loadData, FinishFunction finish, bool withNeighbours, int priority)
+	: jobSystem(jobSystem), mutex(mutex), loadData(loadData), finish(finish), withNeighbours(withNeighbours), priority(priority)
+{
+
+}
+
+ChunkStreamer::~ChunkStreamer()
+{
+	for (auto& it : chunkData)
+		delete it.second;
+}
+
+void ChunkStreamer::setRange(int distance, int height)
+{
+	residency.setRange(distance, height);
+}
+
+void ChunkStreamer::setObserver(int id, ChunkPos center)
+{
+	residency.setObserver(id, center);
+}
+
+void ChunkStreamer::removeObserver(int id)
+{
+	residency.removeObserver(id);
+}
+
+void ChunkStreamer::dispatch()
+{
+	ChunkPos chunkPos;
+	while (loadingChunks.size() < jobSystem.getThreadCount() * CHUNKS_IN_FLIGHT_PER_THREAD && residency.nextToLoad(chunkPos))
+	{
+		if (loadedChunks.find(chunkPos) != loadedChunks.end())
+		{
+			residency.setLoaded(chunkPos);
+			continue;
+		}
+
+		startLoading(chunkPos);
+	}
+}
+
+bool ChunkStreamer::finishLoading(ChunkPos chunkPos)
+{
+	loadingChunks.erase(chunkPos);
+	loadedChunks.insert(chunkPos);
+
+	bool wanted = residency.setLoaded(chunkPos);
+	if (!wanted)
+		released.push_back(chunkPos);
+
+	dispatch();
+	return wanted;
+}
+
+void ChunkStreamer::takeReleased(std::vector<ChunkPos>& out)
+{
+	residency.takeReleased(out);
+	out.insert(out.end(), released.begin(), released.end());
+	released.clear();
+}
+
+bool ChunkStreamer::reclaim(ChunkPos chunkPos)
+{
+	if (!residency.isResident(chunkPos))
+		return false;
+
+	// Left pending, its observers could leave again before dispatch gets to it and it would never be released
+	residency.setLoaded(chunkPos);
+	return true;
+}
+
+void ChunkStreamer::unload(ChunkPos chunkPos)
+{
+	loadedChunks.erase(chunkPos);
+
+	const std::vector<ChunkPos>& offsets = getDataOffsets();
+	for (const ChunkPos& offset : offsets)
+	{
+		ChunkPos dataPos(chunkPos.x + offset.x, chunkPos.y + offset.y, chunkPos.z + offset.z);
+		auto data = chunkData.find(dataPos);
+		if (data == chunkData.end())
+			continue;
+
+		bool used = false;
+		for (const ChunkPos& user : offsets)
+		{
+			ChunkPos userPos(dataPos.x - user.x, dataPos.y - user.y, dataPos.z - user.z);
+			if (loadedChunks.find(userPos) != loadedChunks.end() || loadingChunks.find(userPos) != loadingChunks.end())
+			{
+				used = true;
+				break;
+			}
+		}
+
+		if (!used)
+		{
+			delete data->second;
+			chunkData.erase(data);
+		}
+	}
+}
+
+ChunkData* ChunkStreamer::getData(ChunkPos chunkPos) const
+{
+	auto it = chunkData.find(chunkPos);
+	return it != chunkData.end() ? it->second : nullptr;
+}
+
+const std::unordered_map<ChunkPos, ChunkData*, ChunkPosHash>& ChunkStreamer::getAllData() const
+{
+	return chunkData;
+}
+
+unsigned int ChunkStreamer::getBacklog() const
+{
+	return residency.getPendingCount() + (unsigned int)loadingChunks.size();
+}
+
+// Private
+// Loads whatever data the chunk needs that isn't there or on its way, then runs the finish job
+void ChunkStreamer::startLoading(ChunkPos chunkPos)
+{
+	loadingChunks.insert(chunkPos);
+
+	JobHandle finishJob = jobSystem.createJob([this, chunkPos]()
+	{
+		finish(chunkPos);
+	});
+	finishJob->priority = priority;
+
+	for (const ChunkPos& offset : getDataOffsets())
+	{
+		ChunkPos dataPos(chunkPos.x + offset.x, chunkPos.y + offset.y, chunkPos.z + offset.z);
+		if (chunkData.find(dataPos) != chunkData.end())
+			continue;
+
+		auto it = dataJobs.find(dataPos);
+		if (it != dataJobs.end())
+		{
+			jobSystem.addDependency(finishJob, it->second);
+			continue;
+		}
+
+		JobHandle dataJob = jobSystem.createJob([this, dataPos]()
+		{
+			ChunkData* data = loadData(dataPos);
+
+			mutex.lock();
+			chunkData[dataPos] = data;
+			dataJobs.erase(dataPos);
+			mutex.unlock();
+		});
+		dataJob->priority = priority;
+		dataJobs[dataPos] = dataJob;
+		jobSystem.addDependency(finishJob, dataJob);
+		jobSystem.submit(dataJob);
+	}
+
+	jobSystem.submit(finishJob);
+}
+
+// Where the data a chunk needs lies relative to it
+const std::vector<ChunkPos>& ChunkStreamer::getDataOffsets() const
+{
+	return withNeighbours ? neighbourOffsets : chunkOffsets;
+}
\ No newline at end of file
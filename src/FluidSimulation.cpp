@@ -0,0 +1,164 @@
+#include "headers/FluidSimulation.h"
+
+#include "headers/Blocks.h"
+
+static const int horizontalOffsets[4][2]{
+	{ -1,  0 },
+	{  1,  0 },
+	{  0, -1 },
+	{  0,  1 }
+};
+
+// Blocks water washes away when it flows into them
+static bool isReplaceable(uint16_t block)
+{
+	return block == Blocks::AIR || Blocks::blocks[block].blockType == Block::BILLBOARD;
+}
+
+FluidSimulation::FluidSimulation(BlockAccess& world)
+	: world(world)
+{
+
+}
+
+void FluidSimulation::blockChanged(int x, int y, int z)
+{
+	BlockPos pos(x, y, z);
+
+	schedule(pos, WATER_DELAY);
+	scheduleNeighbors(pos);
+}
+
+void FluidSimulation::tick()
+{
+	currentTick++;
+
+	// Take the slot so cells scheduled while updating land in later slots
+	std::vector<BlockPos> cells;
+	cells.swap(wheel[currentTick % WHEEL_SIZE]);
+
+	lastTickCells = 0;
+	for (const BlockPos& pos : cells)
+	{
+		auto it = scheduled.find(pos);
+		if (it == scheduled.end() || it->second != currentTick)
+			continue;
+
+		scheduled.erase(it);
+		updateCell(pos);
+		lastTickCells++;
+	}
+}
+
+void FluidSimulation::schedule(BlockPos pos, unsigned int delay)
+{
+	uint64_t tick = currentTick + delay;
+
+	auto it = scheduled.find(pos);
+	if (it != scheduled.end() && it->second <= tick)
+		return;
+
+	scheduled[pos] = tick;
+	wheel[tick % WHEEL_SIZE].push_back(pos);
+}
+
+void FluidSimulation::scheduleNeighbors(BlockPos pos)
+{
+	int x = std::get<0>(pos);
+	int y = std::get<1>(pos);
+	int z = std::get<2>(pos);
+
+	schedule({ x, y - 1, z }, WATER_DELAY);
+	schedule({ x, y + 1, z }, WATER_DELAY);
+	for (int i = 0; i < 4; i++)
+		schedule({ x + horizontalOffsets[i][0], y, z + horizontalOffsets[i][1] }, WATER_DELAY);
+}
+
+// Level of the water at pos, -1 if it is not water
+int FluidSimulation::getFlowLevel(BlockPos pos)
+{
+	uint16_t block;
+	if (!world.getBlock(std::get<0>(pos), std::get<1>(pos), std::get<2>(pos), block) || block != Blocks::WATER)
+		return -1;
+
+	return world.getFlowLevel(std::get<0>(pos), std::get<1>(pos), std::get<2>(pos));
+}
+
+bool FluidSimulation::setWater(BlockPos pos, uint8_t level)
+{
+	if (!world.setBlock(std::get<0>(pos), std::get<1>(pos), std::get<2>(pos), Blocks::WATER))
+		return false;
+
+	world.setFlowLevel(std::get<0>(pos), std::get<1>(pos), std::get<2>(pos), level);
+	schedule(pos, WATER_DELAY);
+	scheduleNeighbors(pos);
+	return true;
+}
+
+void FluidSimulation::updateCell(BlockPos pos)
+{
+	int x = std::get<0>(pos);
+	int y = std::get<1>(pos);
+	int z = std::get<2>(pos);
+
+	int level = getFlowLevel(pos);
+	if (level < 0)
+		return;
+
+	// Flowing water is fed by water above it or by a shallower horizontal neighbour
+	if (level > 0)
+	{
+		int fedLevel = MAX_FLOW + 1;
+		if (getFlowLevel({ x, y + 1, z }) >= 0)
+		{
+			fedLevel = 1;
+		}
+		else
+		{
+			for (int i = 0; i < 4; i++)
+			{
+				int neighborLevel = getFlowLevel({ x + horizontalOffsets[i][0], y, z + horizontalOffsets[i][1] });
+				if (neighborLevel >= 0 && neighborLevel + 1 < fedLevel)
+					fedLevel = neighborLevel + 1;
+			}
+		}
+
+		if (fedLevel > MAX_FLOW)
+		{
+			// Cut off, drain away
+			if (world.setBlock(x, y, z, Blocks::AIR))
+				scheduleNeighbors(pos);
+			return;
+		}
+
+		if (fedLevel != level)
+		{
+			world.setFlowLevel(x, y, z, fedLevel);
+			level = fedLevel;
+			scheduleNeighbors(pos);
+		}
+	}
+
+	// Fall first, only spread sideways when resting on something
+	uint16_t below;
+	if (!world.getBlock(x, y - 1, z, below))
+		return;
+
+	if (isReplaceable(below))
+	{
+		setWater({ x, y - 1, z }, 1);
+		return;
+	}
+
+	if (below == Blocks::WATER || level >= MAX_FLOW)
+		return;
+
+	for (int i = 0; i < 4; i++)
+	{
+		BlockPos neighbor(x + horizontalOffsets[i][0], y, z + horizontalOffsets[i][1]);
+
+		uint16_t block;
+		if (world.getBlock(std::get<0>(neighbor), y, std::get<2>(neighbor), block) && isReplaceable(block))
+			setWater(neighbor, level + 1);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#include "headers/GLCommandQueue.h"
+
+#include <chrono>
+
+void GLCommandQueue::submit(std::function<void()> command)
+{
+	mutex.lock();
+	commands.push_back(std::move(command));
+	mutex.unlock();
+}
+
+unsigned int GLCommandQueue::execute(float budgetMilliseconds)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	mutex.lock();
+	size_t queued = commands.size();
+	mutex.unlock();
+
+	unsigned int executed = 0;
+	while (executed < queued)
+	{
+		mutex.lock();
+		std::function<void()> command = std::move(commands.front());
+		commands.pop_front();
+		mutex.unlock();
+
+		command();
+		executed++;
+
+		if (std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() >= budgetMilliseconds)
+			break;
+	}
+
+	return executed;
+}
+
+size_t GLCommandQueue::getPendingCount()
+{
+	mutex.lock();
+	size_t count = commands.size();
+	mutex.unlock();
+	return count;
+}
\ No newline at end of file
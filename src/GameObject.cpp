@@ -101,18 +101,40 @@ void GameObject::init() {
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *) 0);
 
-    fpsSlider = Slider(windowX / 2, windowY / 2, 300.0f, 20.0f, 0.0f, 100.0f, 50.0f);
+    fpsSlider = Slider(windowX / 2, windowY / 2, 300.0f, 20.0f, 30.0f, 144.0f, 60.0f);
 
     Planet::planet = new Planet(&worldShader, &fluidShader, &billboardShader);
+    metrics.open("metrics.log", std::ios::trunc);
+    Planet::planet->renderDistanceGovernor.metrics = &metrics;
 
     graphics::setPreDrawFunction([this,outlineVAO] {
         std::string window_name
                 = "Fake Minecraft / FPS: "
                   + std::to_string(graphics::getFPS())
+                  + " View: "
+                  + std::to_string(Planet::planet->renderDistance)
                   + " Total Chunks: "
                   + std::to_string(Planet::planet->numChunks)
                   + " Rendered Chunks: "
-                  + std::to_string(Planet::planet->numChunksRendered);
+                  + std::to_string(Planet::planet->numChunksRendered)
+                  + " Occluded: "
+                  + std::to_string(Planet::planet->numChunksOccluded)
+                  + " Below Horizon: "
+                  + std::to_string(Planet::planet->numChunksBelowHorizon)
+                  + " Cells Culled: "
+                  + std::to_string(Planet::planet->numCellsCulled)
+                  + " Draw Calls: "
+                  + std::to_string(Planet::planet->renderQueue.drawCalls)
+                  + " Triangles: "
+                  + std::to_string(Planet::planet->renderQueue.trianglesDrawn)
+                  + " State Changes: "
+                  + std::to_string(Planet::planet->renderQueue.stateChanges)
+                  + " Light Update: "
+                  + std::to_string(Planet::planet->lightUpdateVoxels)
+                  + " GL Commands: "
+                  + std::to_string(Planet::planet->glCommandsExecuted)
+                  + "/"
+                  + std::to_string(Planet::planet->glCommands.getPendingCount());
 
         graphics::setWindowName(window_name.c_str()); {
             glClearColor(0.6f, 0.8f, 1.0f, 1.0f);
@@ -148,7 +170,7 @@ void GameObject::init() {
         outlineShader["SMART_projection"] = projection;
         //--------------------------------------------
 
-        Planet::planet->update(camera.Position); {
+        Planet::planet->update(camera.Position, projection * view); {
             // Get block position
             outlineShader.use(true);
             auto result = Physics::raycast(camera.Position, camera.Front, 5);
@@ -234,6 +256,12 @@ void GameObject::init() {
     graphics::setUpdateFunction([this](float dt) {
         keyboardCallBack(dt);
         mouseCallBack();
+
+        if (gameState.state == PLAYING)
+            Planet::planet->updateTicks(dt);
+
+        Planet::planet->renderDistanceGovernor.setTargetFps(fpsSlider.currentValue);
+        Planet::planet->updateRenderDistance(dt);
     });
 
     graphics::startMessageLoop();
@@ -0,0 +1,205 @@
+#include "headers/HorizonCuller.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <queue>
+#include <glm/gtc/constants.hpp>
+
+#include "headers/WorldGen.h"
+#include "Chunk/headers/ChunkData.h"
+
+void HorizonCuller::build(glm::vec3 eye, int startX, int startZ, int size, const std::vector<float>& groundHeights)
+{
+	this->eye = eye;
+	this->startX = startX;
+	this->startZ = startZ;
+	this->size = size;
+	columns.resize(size * size);
+	horizon.assign(AZIMUTH_BINS, -INFINITY);
+
+	const float binWidth = glm::two_pi<float>() / AZIMUTH_BINS;
+	// Azimuth ranges of each column as bins, the ones it touches and the ones it spans entirely. Ranges may wrap.
+	std::vector<int> firstTouched(columns.size()), lastTouched(columns.size());
+	std::vector<int> firstSpanned(columns.size()), lastSpanned(columns.size());
+	std::vector<int> order(columns.size());
+
+	for (int x = 0; x < size; x++)
+	{
+		for (int z = 0; z < size; z++)
+		{
+			int index = x * size + z;
+			order[index] = index;
+
+			float minX = (startX + x) * (float)CHUNK_SIZE - eye.x;
+			float minZ = (startZ + z) * (float)CHUNK_SIZE - eye.z;
+			float maxX = minX + CHUNK_SIZE;
+			float maxZ = minZ + CHUNK_SIZE;
+
+			Column& column = columns[index];
+			float nearestX = std::max({ minX, 0.0f, -maxX });
+			float nearestZ = std::max({ minZ, 0.0f, -maxZ });
+			float farthestX = std::max(fabsf(minX), fabsf(maxX));
+			float farthestZ = std::max(fabsf(minZ), fabsf(maxZ));
+			column.nearest = sqrtf(nearestX * nearestX + nearestZ * nearestZ);
+			column.farthest = sqrtf(farthestX * farthestX + farthestZ * farthestZ);
+			column.ground = groundHeights[index];
+			column.horizon = -INFINITY;
+			if (column.nearest == 0.0f)
+				continue;
+
+			// A column not containing the eye spans less than half a turn, so corners are measured from its center
+			float center = atan2f(minZ + CHUNK_SIZE / 2.0f, minX + CHUNK_SIZE / 2.0f);
+			float low = 0.0f, high = 0.0f;
+			for (int corner = 0; corner < 4; corner++)
+			{
+				float angle = atan2f(corner & 2 ? maxZ : minZ, corner & 1 ? maxX : minX) - center;
+				angle = remainderf(angle, glm::two_pi<float>());
+				low = std::min(low, angle);
+				high = std::max(high, angle);
+			}
+			low = (center + low + glm::pi<float>()) / binWidth;
+			high = (center + high + glm::pi<float>()) / binWidth;
+			firstTouched[index] = (int)floorf(low);
+			lastTouched[index] = (int)floorf(high);
+			firstSpanned[index] = (int)ceilf(low);
+			lastSpanned[index] = (int)floorf(high) - 1;
+		}
+	}
+
+	std::sort(order.begin(), order.end(), [this](int a, int b) { return columns[a].nearest < columns[b].nearest; });
+
+	// Columns wait to raise the horizon until every column still to come lies entirely behind them
+	typedef std::pair<float, int> Pending;
+	std::priority_queue<Pending, std::vector<Pending>, std::greater<Pending>> pending;
+
+	for (int index : order)
+	{
+		Column& column = columns[index];
+		if (column.nearest == 0.0f)
+			continue;
+
+		while (!pending.empty() && pending.top().first <= column.nearest)
+		{
+			int occluder = pending.top().second;
+			pending.pop();
+
+			// The steepest line of sight that still hits the ground somewhere over the column, for any azimuth
+			float ground = columns[occluder].ground;
+			float elevation = ground >= eye.y
+				? (ground - eye.y) / columns[occluder].farthest
+				: (ground - eye.y) / columns[occluder].nearest;
+			for (int bin = firstSpanned[occluder]; bin <= lastSpanned[occluder]; bin++)
+			{
+				float& binHorizon = horizon[(bin % AZIMUTH_BINS + AZIMUTH_BINS) % AZIMUTH_BINS];
+				binHorizon = std::max(binHorizon, elevation);
+			}
+		}
+
+		column.horizon = INFINITY;
+		for (int bin = firstTouched[index]; bin <= lastTouched[index]; bin++)
+			column.horizon = std::min(column.horizon, horizon[(bin % AZIMUTH_BINS + AZIMUTH_BINS) % AZIMUTH_BINS]);
+
+		if (column.ground != -INFINITY)
+			pending.push({ column.farthest, index });
+	}
+}
+
+bool HorizonCuller::isHidden(ChunkPos chunkPos) const
+{
+	int x = chunkPos.x - startX;
+	int z = chunkPos.z - startZ;
+	if (x < 0 || z < 0 || x >= size || z >= size)
+		return false;
+
+	const Column& column = columns[x * size + z];
+	float top = (chunkPos.y + 1) * (float)CHUNK_SIZE;
+	if (column.nearest == 0.0f || top <= column.ground)
+		return false;
+
+	// The steepest the chunk's top can be seen at
+	float elevation = top >= eye.y ? (top - eye.y) / column.nearest : (top - eye.y) / column.farthest;
+	return elevation < column.horizon;
+}
+
+static bool check(const char* name, bool passed)
+{
+	std::cout << (passed ? "  ok      " : "  FAILED  ") << name << '\n';
+	return passed;
+}
+
+bool HorizonCuller::runBenchmark()
+{
+	HorizonCuller culler;
+	bool passed = true;
+
+	std::cout << "Horizon culling checks\n";
+	{
+		// Flat unknown ground with one ridge column two chunks east of the eye
+		const int size = 9;
+		std::vector<float> grounds(size * size, -INFINITY);
+		grounds[(2 + 4) * size + 4] = 50.0f;
+		culler.build(glm::vec3(16.0f, 10.0f, 16.0f), -4, -4, size, grounds);
+
+		passed &= check("chunk behind a ridge is hidden", culler.isHidden(ChunkPos(4, 0, 0)));
+		passed &= check("chunk above the ridge line is not", !culler.isHidden(ChunkPos(4, 2, 0)));
+		passed &= check("chunk in front of the ridge is not", !culler.isHidden(ChunkPos(1, 0, 0)));
+		passed &= check("chunk partly beside the ridge is not", !culler.isHidden(ChunkPos(4, 0, 1)));
+		passed &= check("chunk of the eye's column is not", !culler.isHidden(ChunkPos(0, -1, 0)));
+
+		grounds[(4 + 4) * size + 4] = 40.0f;
+		culler.build(glm::vec3(16.0f, 10.0f, 16.0f), -4, -4, size, grounds);
+		passed &= check("chunk under its own ground is not", !culler.isHidden(ChunkPos(4, 0, 0)));
+		passed &= check("chunk reaching out of its ground is", culler.isHidden(ChunkPos(4, 1, 0)));
+	}
+
+	// Generated terrain around the origin, grounds from the lowest surface of each column like in the game
+	const int range = 8;
+	const int height = 3;
+	const int size = range * 2 + 1;
+	std::vector<int> heights(size * CHUNK_SIZE * size * CHUNK_SIZE);
+	WorldGen::surfaceHeights(-range * (int)CHUNK_SIZE, -range * (int)CHUNK_SIZE, size * CHUNK_SIZE, size * CHUNK_SIZE, heights.data());
+
+	std::vector<float> grounds(size * size, INFINITY);
+	for (int x = 0; x < size * (int)CHUNK_SIZE; x++)
+	{
+		for (int z = 0; z < size * (int)CHUNK_SIZE; z++)
+		{
+			float& ground = grounds[(x / CHUNK_SIZE) * size + z / CHUNK_SIZE];
+			ground = std::min(ground, heights[x * size * CHUNK_SIZE + z] + 1.0f);
+		}
+	}
+
+	const int frames = 2000;
+	unsigned int tested = 0, hidden = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (int frame = 0; frame < frames; frame++)
+	{
+		// Walk a line across the area so the eye moves through valleys and over hills
+		float walk = (frame % 200) * (float)CHUNK_SIZE * range / 200.0f - CHUNK_SIZE * range / 2.0f;
+		glm::vec3 eye(walk, WorldGen::surfaceHeight((int)floorf(walk), 0) + 2.0f, 0.5f);
+		culler.build(eye, -range, -range, size, grounds);
+
+		int eyeChunkY = (int)floorf(eye.y / CHUNK_SIZE);
+		for (int x = -range; x <= range; x++)
+		{
+			for (int z = -range; z <= range; z++)
+			{
+				for (int y = eyeChunkY - height; y <= eyeChunkY + height; y++)
+				{
+					tested++;
+					if (culler.isHidden(ChunkPos(x, y, z)))
+						hidden++;
+				}
+			}
+		}
+	}
+	double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << "Terrain, " << size << "x" << size << " columns, " << AZIMUTH_BINS << " azimuths\n"
+		<< "  " << milliseconds / frames << " ms per frame, "
+		<< (float)hidden / frames << " of " << (float)tested / frames << " chunks hidden\n";
+
+	return passed;
+}
@@ -0,0 +1,335 @@
+#include "headers/JobSystem.h"
+
+#include <chrono>
+#include <iostream>
+
+// The system and worker index of the calling thread, so jobs submitted from a job stay on its worker
+static thread_local const JobSystem* currentSystem = nullptr;
+static thread_local int currentWorker = -1;
+
+JobSystem::JobSystem(unsigned int threadCount)
+{
+	for (unsigned int i = 0; i < threadCount; i++)
+	{
+		workers.emplace_back(new Worker());
+		workers.back()->seed = i * 2654435761u + 1;
+	}
+
+	for (unsigned int i = 0; i < threadCount; i++)
+		workers[i]->thread = std::thread(&JobSystem::workerUpdate, this, i);
+}
+
+JobSystem::~JobSystem()
+{
+	waitIdle();
+
+	shouldEnd = true;
+	wake(true);
+
+	for (auto& worker : workers)
+		worker->thread.join();
+}
+
+JobHandle JobSystem::createJob(std::function<void()> work)
+{
+	JobHandle job = std::make_shared<Job>();
+	job->work = std::move(work);
+	return job;
+}
+
+void JobSystem::addDependency(const JobHandle& job, const JobHandle& dependency)
+{
+	std::lock_guard<std::mutex> lock(dependency->mutex);
+	if (dependency->finished)
+		return;
+
+	job->remaining++;
+	dependency->continuations.push_back(job);
+}
+
+void JobSystem::submit(const JobHandle& job)
+{
+	activeJobs++;
+
+	if (--job->remaining == 0)
+		enqueue(job);
+}
+
+bool JobSystem::isFinished(const JobHandle& job)
+{
+	std::lock_guard<std::mutex> lock(job->mutex);
+	return job->finished;
+}
+
+void JobSystem::waitIdle()
+{
+	std::unique_lock<std::mutex> lock(idleMutex);
+	idleCondition.wait(lock, [this] { return activeJobs == 0; });
+}
+
+unsigned int JobSystem::getThreadCount() const
+{
+	return workers.size();
+}
+
+int JobSystem::getWorkerIndex() const
+{
+	return currentSystem == this ? currentWorker : -1;
+}
+
+JobSystem::Stats JobSystem::getStats() const
+{
+	Stats stats;
+	stats.jobsRun = jobsRun;
+	stats.steals = steals;
+	stats.injected = injected;
+	stats.sleeps = sleeps;
+	return stats;
+}
+
+// A few microseconds of work, about what the smallest real jobs cost
+static void spin(unsigned int iterations)
+{
+	volatile uint32_t value = 1;
+	for (unsigned int i = 0; i < iterations; i++)
+		value = value * 1664525u + 1013904223u;
+}
+
+static void printResult(const char* name, unsigned int threads, unsigned int jobCount, double milliseconds, JobSystem::Stats stats)
+{
+	std::cout << "  " << name << " threads " << threads
+		<< ": " << milliseconds << " ms, " << (uint64_t)(jobCount / milliseconds * 1000.0) << " jobs/s"
+		<< ", steals " << stats.steals << ", injected " << stats.injected << ", sleeps " << stats.sleeps << '\n';
+}
+
+void JobSystem::runBenchmark(unsigned int maxThreads)
+{
+	const unsigned int injectedJobs = 200000;
+	const unsigned int rootJobs = 64;
+	const unsigned int childJobs = 4000;
+	const unsigned int chunkGrid = 32;
+
+	std::cout << "Job system benchmark, " << std::thread::hardware_concurrency() << " hardware threads\n";
+
+	for (unsigned int threads = 1; threads <= maxThreads; threads *= 2)
+	{
+		// Contention: every job goes through the injection queue from one outside thread
+		{
+			JobSystem jobSystem(threads);
+			auto start = std::chrono::steady_clock::now();
+			for (unsigned int i = 0; i < injectedJobs; i++)
+				jobSystem.submit(jobSystem.createJob([] { spin(200); }));
+			jobSystem.waitIdle();
+			double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			printResult("injected", threads, injectedJobs, milliseconds, jobSystem.getStats());
+		}
+
+		// Throughput: a few roots fan out on their own workers and the rest is stolen
+		{
+			JobSystem jobSystem(threads);
+			auto start = std::chrono::steady_clock::now();
+			for (unsigned int i = 0; i < rootJobs; i++)
+			{
+				jobSystem.submit(jobSystem.createJob([&jobSystem, childJobs]
+				{
+					for (unsigned int j = 0; j < childJobs; j++)
+						jobSystem.submit(jobSystem.createJob([] { spin(200); }));
+				}));
+			}
+			jobSystem.waitIdle();
+			double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			printResult("fan-out", threads, rootJobs * (childJobs + 1), milliseconds, jobSystem.getStats());
+		}
+
+		// Chunk graph: a data job per column of a grid, a mesh job per cell waiting on its own and four neighbours' data
+		{
+			JobSystem jobSystem(threads);
+			auto start = std::chrono::steady_clock::now();
+			std::vector<JobHandle> dataJobs;
+			for (unsigned int i = 0; i < chunkGrid * chunkGrid; i++)
+				dataJobs.push_back(jobSystem.createJob([] { spin(20000); }));
+
+			for (unsigned int x = 1; x < chunkGrid - 1; x++)
+			{
+				for (unsigned int z = 1; z < chunkGrid - 1; z++)
+				{
+					JobHandle meshJob = jobSystem.createJob([] { spin(10000); });
+					jobSystem.addDependency(meshJob, dataJobs[x * chunkGrid + z]);
+					jobSystem.addDependency(meshJob, dataJobs[(x + 1) * chunkGrid + z]);
+					jobSystem.addDependency(meshJob, dataJobs[(x - 1) * chunkGrid + z]);
+					jobSystem.addDependency(meshJob, dataJobs[x * chunkGrid + z + 1]);
+					jobSystem.addDependency(meshJob, dataJobs[x * chunkGrid + z - 1]);
+					jobSystem.submit(meshJob);
+				}
+			}
+			for (JobHandle& dataJob : dataJobs)
+				jobSystem.submit(dataJob);
+			jobSystem.waitIdle();
+			double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			printResult("chunk graph", threads, chunkGrid * chunkGrid + (chunkGrid - 2) * (chunkGrid - 2), milliseconds, jobSystem.getStats());
+		}
+	}
+}
+
+// Private
+void JobSystem::workerUpdate(unsigned int index)
+{
+	currentSystem = this;
+	currentWorker = index;
+	Worker& worker = *workers[index];
+
+	while (true)
+	{
+		Job* job = findJob(index);
+		if (job != nullptr)
+		{
+			run(job);
+			continue;
+		}
+
+		if (shouldEnd)
+			return;
+
+		// sleepingWorkers is raised before the counters are checked, so an enqueue either is seen here or
+		// sees the sleeper and wakes it
+		auto hasWork = [this, &worker] { return queuedJobs > 0 || worker.mailboxSize > 0 || shouldEnd; };
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		sleepingWorkers++;
+		if (!hasWork())
+		{
+			sleeps++;
+			sleepCondition.wait(lock, hasWork);
+		}
+		sleepingWorkers--;
+	}
+}
+
+// Own mailbox, own deque, the injection queue, then stealing from the other workers starting at a random one
+Job* JobSystem::findJob(unsigned int index)
+{
+	Worker& worker = *workers[index];
+
+	if (worker.mailboxSize > 0)
+	{
+		std::lock_guard<std::mutex> lock(worker.mailboxMutex);
+		Job* job = worker.mailbox.front();
+		worker.mailbox.pop();
+		worker.mailboxSize--;
+		return job;
+	}
+
+	if (Job* job = worker.deque.pop())
+	{
+		queuedJobs--;
+		return job;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(injectionMutex);
+		if (!injectionQueue.empty())
+		{
+			Job* job = injectionQueue.top().job;
+			injectionQueue.pop();
+			queuedJobs--;
+			return job;
+		}
+	}
+
+	// xorshift
+	worker.seed ^= worker.seed << 13;
+	worker.seed ^= worker.seed >> 7;
+	worker.seed ^= worker.seed << 17;
+
+	unsigned int count = workers.size();
+	unsigned int start = worker.seed % count;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		unsigned int victim = (start + i) % count;
+		if (victim == index)
+			continue;
+
+		if (Job* job = workers[victim]->deque.steal())
+		{
+			queuedJobs--;
+			steals++;
+			return job;
+		}
+	}
+
+	return nullptr;
+}
+
+void JobSystem::run(Job* job)
+{
+	JobHandle handle = std::move(job->self);
+	handle->work();
+
+	// Mark the job finished and start the continuations it was the last dependency of
+	std::vector<JobHandle> continuations;
+	{
+		std::lock_guard<std::mutex> lock(handle->mutex);
+		handle->finished = true;
+		continuations.swap(handle->continuations);
+	}
+
+	for (JobHandle& continuation : continuations)
+	{
+		if (--continuation->remaining == 0)
+			enqueue(std::move(continuation));
+	}
+
+	jobsRun++;
+	if (--activeJobs == 0)
+	{
+		std::lock_guard<std::mutex> lock(idleMutex);
+		idleCondition.notify_all();
+	}
+}
+
+void JobSystem::enqueue(JobHandle job)
+{
+	Job* pointer = job.get();
+	int affinity = job->affinity;
+	pointer->self = std::move(job);
+
+	if (affinity >= 0 && affinity < (int)workers.size())
+	{
+		Worker& worker = *workers[affinity];
+		{
+			std::lock_guard<std::mutex> lock(worker.mailboxMutex);
+			worker.mailbox.push(pointer);
+		}
+		worker.mailboxSize++;
+		// Condition variables can't wake one chosen thread
+		wake(true);
+		return;
+	}
+
+	int index = getWorkerIndex();
+	if (index >= 0)
+	{
+		workers[index]->deque.push(pointer);
+	}
+	else
+	{
+		std::lock_guard<std::mutex> lock(injectionMutex);
+		injectionQueue.push({ pointer->priority, injectionSequence++, pointer });
+		injected++;
+	}
+
+	queuedJobs++;
+	wake(false);
+}
+
+void JobSystem::wake(bool all)
+{
+	if (sleepingWorkers == 0)
+		return;
+
+	// Taking the lock orders the wake after a worker's check of the counters, so it can't be missed
+	std::lock_guard<std::mutex> lock(sleepMutex);
+	if (all)
+		sleepCondition.notify_all();
+	else
+		sleepCondition.notify_one();
+}
\ No newline at end of file
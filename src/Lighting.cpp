@@ -0,0 +1,381 @@
+#include "headers/Lighting.h"
+
+#include <algorithm>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "headers/Blocks.h"
+#include "Chunk/headers/ChunkData.h"
+#include "Chunk/headers/ChunkPosHash.h"
+#include "headers/WorldGen.h"
+
+enum LIGHT_CHANNEL
+{
+	SKY,
+	BLOCK
+};
+
+static const int size = CHUNK_SIZE;
+
+// West, east, down, up, north, south
+static const int neighborOffsets[6][3]{
+	{ -1,  0,  0 },
+	{  1,  0,  0 },
+	{  0, -1,  0 },
+	{  0,  1,  0 },
+	{  0,  0, -1 },
+	{  0,  0,  1 }
+};
+static const int DOWN = 2;
+
+static int getIndex(int x, int y, int z)
+{
+	return x * size * size + z * size + y;
+}
+
+// Light lost when entering a block, MAX_LIGHT means the block stops light entirely
+static int getAttenuation(uint16_t block)
+{
+	switch (Blocks::blocks[block].blockType)
+	{
+		case Block::SOLID:
+			return Lighting::MAX_LIGHT;
+		case Block::LEAVES:
+		case Block::LIQUID:
+			return 2;
+		default:
+			return 1;
+	}
+}
+
+static int getLevel(const uint8_t* light, int index, int channel)
+{
+	return channel == SKY ? light[index] >> 4 : light[index] & 0x0F;
+}
+
+static void setLevel(uint8_t* light, int index, int channel, int level)
+{
+	if (channel == SKY)
+		light[index] = (light[index] & 0x0F) | (level << 4);
+	else
+		light[index] = (light[index] & 0xF0) | level;
+}
+
+// Full sky light keeps falling straight down through clear blocks, everything else fades by the attenuation
+static int getSpreadLevel(int channel, int direction, int level, int attenuation)
+{
+	if (channel == SKY && direction == DOWN && level == Lighting::MAX_LIGHT && attenuation == 1)
+		return Lighting::MAX_LIGHT;
+
+	return level - attenuation;
+}
+
+// Light kept inside one chunk, for lighting a chunk on its own. Voxels are indices into the chunk's arrays.
+struct ChunkVolume
+{
+	typedef int Voxel;
+
+	ChunkData* chunkData;
+
+	uint16_t getBlock(Voxel voxel) const
+	{
+		return chunkData->data[voxel];
+	}
+
+	int getLevel(Voxel voxel, int channel) const
+	{
+		return ::getLevel(chunkData->light, voxel, channel);
+	}
+
+	void setLevel(Voxel voxel, int channel, int level)
+	{
+		::setLevel(chunkData->light, voxel, channel, level);
+	}
+
+	bool getNeighbor(Voxel voxel, int direction, Voxel& neighbor) const
+	{
+		int nX = voxel / (size * size) + neighborOffsets[direction][0];
+		int nY = voxel % size + neighborOffsets[direction][1];
+		int nZ = (voxel / size) % size + neighborOffsets[direction][2];
+		if (nX < 0 || nX >= size || nY < 0 || nY >= size || nZ < 0 || nZ >= size)
+			return false;
+
+		neighbor = getIndex(nX, nY, nZ);
+		return true;
+	}
+};
+
+// Light that crosses into every loaded chunk it reaches, for updates in a loaded world. Chunks are looked up once
+// each and those whose light changed are remembered, so their meshes can be rebuilt.
+struct WorldVolume
+{
+	struct Voxel
+	{
+		ChunkData* chunkData;
+		ChunkPos chunkPos;
+		int index;
+	};
+
+	WorldVolume(const Lighting::ChunkDataLookup& lookup)
+		: lookup(lookup)
+	{
+
+	}
+
+	ChunkData* findChunk(ChunkPos chunkPos)
+	{
+		auto it = chunks.find(chunkPos);
+		if (it != chunks.end())
+			return it->second;
+
+		ChunkData* chunkData = lookup(chunkPos);
+		chunks[chunkPos] = chunkData;
+		return chunkData;
+	}
+
+	uint16_t getBlock(const Voxel& voxel) const
+	{
+		return voxel.chunkData->data[voxel.index];
+	}
+
+	int getLevel(const Voxel& voxel, int channel) const
+	{
+		return ::getLevel(voxel.chunkData->light, voxel.index, channel);
+	}
+
+	void setLevel(const Voxel& voxel, int channel, int level)
+	{
+		if (voxel.chunkData != lastChanged)
+		{
+			changed.insert(voxel.chunkPos);
+			lastChanged = voxel.chunkData;
+		}
+		::setLevel(voxel.chunkData->light, voxel.index, channel, level);
+	}
+
+	bool getNeighbor(const Voxel& voxel, int direction, Voxel& neighbor)
+	{
+		int nX = voxel.index / (size * size) + neighborOffsets[direction][0];
+		int nY = voxel.index % size + neighborOffsets[direction][1];
+		int nZ = (voxel.index / size) % size + neighborOffsets[direction][2];
+		if (nX >= 0 && nX < size && nY >= 0 && nY < size && nZ >= 0 && nZ < size)
+		{
+			neighbor = { voxel.chunkData, voxel.chunkPos, getIndex(nX, nY, nZ) };
+			return true;
+		}
+
+		ChunkPos chunkPos(voxel.chunkPos.x + neighborOffsets[direction][0], voxel.chunkPos.y + neighborOffsets[direction][1],
+			voxel.chunkPos.z + neighborOffsets[direction][2]);
+		ChunkData* chunkData = findChunk(chunkPos);
+		if (chunkData == nullptr)
+			return false;
+
+		neighbor = { chunkData, chunkPos, getIndex((nX + size) % size, (nY + size) % size, (nZ + size) % size) };
+		return true;
+	}
+
+	const Lighting::ChunkDataLookup& lookup;
+	std::unordered_map<ChunkPos, ChunkData*, ChunkPosHash> chunks;
+	std::unordered_set<ChunkPos, ChunkPosHash> changed;
+	ChunkData* lastChanged = nullptr;
+};
+
+template <typename Volume>
+static unsigned int propagate(Volume& volume, int channel, std::queue<typename Volume::Voxel>& addQueue)
+{
+	unsigned int visited = 0;
+	while (!addQueue.empty())
+	{
+		typename Volume::Voxel voxel = addQueue.front();
+		addQueue.pop();
+		visited++;
+
+		int level = volume.getLevel(voxel, channel);
+		if (level <= 1)
+			continue;
+
+		for (int d = 0; d < 6; d++)
+		{
+			typename Volume::Voxel neighbor;
+			if (!volume.getNeighbor(voxel, d, neighbor))
+				continue;
+
+			int newLevel = getSpreadLevel(channel, d, level, getAttenuation(volume.getBlock(neighbor)));
+			if (newLevel > volume.getLevel(neighbor, channel))
+			{
+				volume.setLevel(neighbor, channel, newLevel);
+				addQueue.push(neighbor);
+			}
+		}
+	}
+
+	return visited;
+}
+
+// Clears the light that came through the queued voxels, lit voxels on the border of the cleared area go to addQueue
+template <typename Volume>
+static unsigned int unpropagate(Volume& volume, int channel, std::queue<std::pair<typename Volume::Voxel, int>>& removeQueue,
+	std::queue<typename Volume::Voxel>& addQueue)
+{
+	unsigned int visited = 0;
+	while (!removeQueue.empty())
+	{
+		typename Volume::Voxel voxel = removeQueue.front().first;
+		int level = removeQueue.front().second;
+		removeQueue.pop();
+		visited++;
+
+		for (int d = 0; d < 6; d++)
+		{
+			typename Volume::Voxel neighbor;
+			if (!volume.getNeighbor(voxel, d, neighbor))
+				continue;
+
+			int neighborLevel = volume.getLevel(neighbor, channel);
+			if (neighborLevel == 0)
+				continue;
+
+			if (neighborLevel < level || (channel == SKY && d == DOWN && level == Lighting::MAX_LIGHT && neighborLevel == Lighting::MAX_LIGHT))
+			{
+				// Lit through the removed voxel
+				volume.setLevel(neighbor, channel, 0);
+				removeQueue.emplace(neighbor, neighborLevel);
+			}
+			else
+			{
+				// Lit from somewhere else, it will refill the gap
+				addQueue.push(neighbor);
+			}
+		}
+	}
+
+	return visited;
+}
+
+// Lights a chunk from scratch, skyAbove holds the sky light entering each column through the top of the chunk
+static void floodChunk(ChunkData* chunkData, const uint8_t* skyAbove)
+{
+	std::fill(chunkData->light, chunkData->light + size * size * size, 0);
+
+	std::queue<int> skyQueue;
+	std::queue<int> blockQueue;
+
+	for (int x = 0; x < size; x++)
+	{
+		for (int z = 0; z < size; z++)
+		{
+			int index = getIndex(x, size - 1, z);
+			int level = getSpreadLevel(SKY, DOWN, skyAbove[x * size + z], getAttenuation(chunkData->data[index]));
+			if (level > 0)
+			{
+				setLevel(chunkData->light, index, SKY, level);
+				skyQueue.push(index);
+			}
+		}
+	}
+
+	for (int index = 0; index < size * size * size; index++)
+	{
+		int emission = Blocks::blocks[chunkData->data[index]].lightEmission;
+		if (emission > 0)
+		{
+			setLevel(chunkData->light, index, BLOCK, emission);
+			blockQueue.push(index);
+		}
+	}
+
+	ChunkVolume volume{ chunkData };
+	propagate(volume, SKY, skyQueue);
+	propagate(volume, BLOCK, blockQueue);
+}
+
+void Lighting::generateChunkLight(ChunkPos chunkPos, ChunkData* chunkData)
+{
+	// Columns whose top is above the terrain surface get sky light from above
+	int heights[CHUNK_SIZE * CHUNK_SIZE];
+	WorldGen::surfaceHeights(chunkPos.x * size, chunkPos.z * size, size, size, heights);
+
+	uint8_t skyAbove[CHUNK_SIZE * CHUNK_SIZE];
+	int topY = chunkPos.y * size + size - 1;
+	for (int i = 0; i < size * size; i++)
+		skyAbove[i] = topY > heights[i] ? MAX_LIGHT : 0;
+
+	floodChunk(chunkData, skyAbove);
+}
+
+bool Lighting::relightChunk(ChunkData* chunkData, ChunkData* upData)
+{
+	uint8_t skyAbove[CHUNK_SIZE * CHUNK_SIZE];
+	uint8_t skyBottom[CHUNK_SIZE * CHUNK_SIZE];
+	for (int x = 0; x < size; x++)
+	{
+		for (int z = 0; z < size; z++)
+		{
+			skyAbove[x * size + z] = upData != nullptr ? upData->getSkyLight(x, 0, z) : MAX_LIGHT;
+			skyBottom[x * size + z] = chunkData->getSkyLight(x, 0, z);
+		}
+	}
+
+	floodChunk(chunkData, skyAbove);
+
+	for (int x = 0; x < size; x++)
+	{
+		for (int z = 0; z < size; z++)
+		{
+			if (chunkData->getSkyLight(x, 0, z) != skyBottom[x * size + z])
+				return true;
+		}
+	}
+
+	return false;
+}
+
+unsigned int Lighting::updateBlock(ChunkPos chunkPos, const ChunkDataLookup& getChunkData, int x, int y, int z,
+	std::vector<ChunkPos>& relitChunks)
+{
+	WorldVolume volume(getChunkData);
+	WorldVolume::Voxel voxel{ volume.findChunk(chunkPos), chunkPos, getIndex(x, y, z) };
+	uint16_t block = volume.getBlock(voxel);
+	int attenuation = getAttenuation(block);
+
+	unsigned int visited = 0;
+	for (int channel = SKY; channel <= BLOCK; channel++)
+	{
+		std::queue<std::pair<WorldVolume::Voxel, int>> removeQueue;
+		std::queue<WorldVolume::Voxel> addQueue;
+
+		// Take away the light that passed through the old block
+		int oldLevel = volume.getLevel(voxel, channel);
+		if (oldLevel > 0)
+		{
+			volume.setLevel(voxel, channel, 0);
+			removeQueue.emplace(voxel, oldLevel);
+			visited += unpropagate(volume, channel, removeQueue, addQueue);
+		}
+
+		int emission = Blocks::blocks[block].lightEmission;
+		if (channel == BLOCK && emission > 0)
+		{
+			volume.setLevel(voxel, channel, emission);
+			addQueue.push(voxel);
+		}
+
+		// Let the neighbours shine into a block that light can pass, sky light from the chunk above included
+		if (attenuation < MAX_LIGHT)
+		{
+			for (int d = 0; d < 6; d++)
+			{
+				WorldVolume::Voxel neighbor;
+				if (volume.getNeighbor(voxel, d, neighbor) && volume.getLevel(neighbor, channel) > 0)
+					addQueue.push(neighbor);
+			}
+		}
+
+		visited += propagate(volume, channel, addQueue);
+	}
+
+	relitChunks.insert(relitChunks.end(), volume.changed.begin(), volume.changed.end());
+	return visited;
+}
\ No newline at end of file
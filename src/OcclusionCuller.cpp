@@ -0,0 +1,386 @@
+#include "headers/OcclusionCuller.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "headers/WorldGen.h"
+#include "Chunk/headers/ChunkData.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OCCLUSION_SSE2
+#endif
+
+// Convex polygons after clipping a quad to the near plane have at most one vertex more
+static constexpr int MAX_POLYGON_POINTS = 8;
+
+OcclusionCuller::OcclusionCuller()
+	: viewProjection(1.0f), cameraPos(0.0f), depth(WIDTH * HEIGHT, 1.0f)
+{
+}
+
+void OcclusionCuller::begin(const glm::mat4& viewProjection, glm::vec3 cameraPos)
+{
+	this->viewProjection = viewProjection;
+	this->cameraPos = cameraPos;
+	std::fill(depth.begin(), depth.end(), 1.0f);
+	facesDrawn = 0;
+
+	// Frustum planes from the rows of the matrix, glm is column major
+	glm::vec4 rows[4];
+	for (int i = 0; i < 4; i++)
+		rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+	for (int i = 0; i < 3; i++)
+	{
+		planes[i * 2] = rows[3] + rows[i];
+		planes[i * 2 + 1] = rows[3] - rows[i];
+	}
+}
+
+void OcclusionCuller::addOccluder(glm::vec3 min, glm::vec3 max)
+{
+	// Only the faces toward the camera, at most three
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float plane;
+		if (cameraPos[axis] < min[axis])
+			plane = min[axis];
+		else if (cameraPos[axis] > max[axis])
+			plane = max[axis];
+		else
+			continue;
+
+		int u = (axis + 1) % 3;
+		int v = (axis + 2) % 3;
+		glm::vec4 corners[4];
+		for (int i = 0; i < 4; i++)
+		{
+			glm::vec3 corner;
+			corner[axis] = plane;
+			corner[u] = i == 1 || i == 2 ? max[u] : min[u];
+			corner[v] = i >= 2 ? max[v] : min[v];
+			corners[i] = viewProjection * glm::vec4(corner, 1.0f);
+		}
+
+		// Clip to the near plane, z >= -w, which also keeps w positive
+		glm::vec3 points[MAX_POLYGON_POINTS];
+		int count = 0;
+		for (int i = 0; i < 4; i++)
+		{
+			const glm::vec4& from = corners[i];
+			const glm::vec4& to = corners[(i + 1) % 4];
+			float fromDistance = from.z + from.w;
+			float toDistance = to.z + to.w;
+
+			glm::vec4 clipped[2];
+			int clippedCount = 0;
+			if (fromDistance >= 0.0f)
+				clipped[clippedCount++] = from;
+			if ((fromDistance >= 0.0f) != (toDistance >= 0.0f))
+				clipped[clippedCount++] = from + (to - from) * (fromDistance / (fromDistance - toDistance));
+
+			for (int j = 0; j < clippedCount; j++)
+			{
+				glm::vec3 ndc = glm::vec3(clipped[j]) / clipped[j].w;
+				points[count++] = glm::vec3((ndc.x * 0.5f + 0.5f) * WIDTH, (ndc.y * 0.5f + 0.5f) * HEIGHT, ndc.z);
+			}
+		}
+
+		if (count >= 3)
+		{
+			rasterizePolygon(points, count);
+			facesDrawn++;
+		}
+	}
+}
+
+bool OcclusionCuller::isInFrustum(glm::vec3 min, glm::vec3 max) const
+{
+	for (const glm::vec4& plane : planes)
+	{
+		// The corner furthest along the plane normal
+		glm::vec3 corner(plane.x >= 0.0f ? max.x : min.x, plane.y >= 0.0f ? max.y : min.y, plane.z >= 0.0f ? max.z : min.z);
+		if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+			return false;
+	}
+	return true;
+}
+
+bool OcclusionCuller::isOccluded(glm::vec3 min, glm::vec3 max) const
+{
+	float minX = (float)WIDTH, minY = (float)HEIGHT, maxX = 0.0f, maxY = 0.0f;
+	float nearest = 1.0f;
+	for (int i = 0; i < 8; i++)
+	{
+		glm::vec3 corner(i & 1 ? max.x : min.x, i & 2 ? max.y : min.y, i & 4 ? max.z : min.z);
+		glm::vec4 clip = viewProjection * glm::vec4(corner, 1.0f);
+		if (clip.z < -clip.w)
+			return false;
+
+		glm::vec3 ndc = glm::vec3(clip) / clip.w;
+		float x = (ndc.x * 0.5f + 0.5f) * WIDTH;
+		float y = (ndc.y * 0.5f + 0.5f) * HEIGHT;
+		minX = std::min(minX, x);
+		maxX = std::max(maxX, x);
+		minY = std::min(minY, y);
+		maxY = std::max(maxY, y);
+		nearest = std::min(nearest, ndc.z);
+	}
+
+	// Every pixel the box touches at all, rows start on a SIMD lane boundary
+	int startX = std::max(0, (int)floorf(minX)) & ~3;
+	int endX = std::min(WIDTH, (int)ceilf(maxX));
+	int startY = std::max(0, (int)floorf(minY));
+	int endY = std::min(HEIGHT, (int)ceilf(maxY));
+	if (startX >= endX || startY >= endY)
+		return false;
+
+#ifdef OCCLUSION_SSE2
+	__m128 boxDepth = _mm_set1_ps(nearest);
+#endif
+	for (int y = startY; y < endY; y++)
+	{
+		const float* row = &depth[y * WIDTH];
+		for (int x = startX; x < endX; x += 4)
+		{
+#ifdef OCCLUSION_SSE2
+			if (_mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(row + x), boxDepth)) != 0)
+				return false;
+#else
+			for (int lane = 0; lane < 4; lane++)
+			{
+				if (row[x + lane] >= nearest)
+					return false;
+			}
+#endif
+		}
+	}
+	return true;
+}
+
+// Private
+void OcclusionCuller::rasterizePolygon(const glm::vec3* points, int count)
+{
+	float minX = points[0].x, maxX = points[0].x, minY = points[0].y, maxY = points[0].y;
+	float area = 0.0f;
+	for (int i = 0; i < count; i++)
+	{
+		const glm::vec3& from = points[i];
+		const glm::vec3& to = points[(i + 1) % count];
+		minX = std::min(minX, from.x);
+		maxX = std::max(maxX, from.x);
+		minY = std::min(minY, from.y);
+		maxY = std::max(maxY, from.y);
+		area += from.x * to.y - to.x * from.y;
+	}
+
+	// Smaller than a pixel covers none whole
+	if (fabsf(area) < 2.0f)
+		return;
+
+	int startX = std::max(0, (int)floorf(minX)) & ~3;
+	int endX = std::min(WIDTH, (int)ceilf(maxX));
+	int startY = std::max(0, (int)floorf(minY));
+	int endY = std::min(HEIGHT, (int)ceilf(maxY));
+	if (startX >= endX || startY >= endY)
+		return;
+
+	// Edge functions a * x + b * y + c, positive inside whatever the winding. Evaluated at pixel centers, less the
+	// most they drop toward a pixel corner, so they pass only for pixels fully inside
+	float sign = area > 0.0f ? 1.0f : -1.0f;
+	float edgeA[MAX_POLYGON_POINTS], edgeB[MAX_POLYGON_POINTS], edgeC[MAX_POLYGON_POINTS];
+	for (int i = 0; i < count; i++)
+	{
+		const glm::vec3& from = points[i];
+		const glm::vec3& to = points[(i + 1) % count];
+		float dx = to.x - from.x;
+		float dy = to.y - from.y;
+		edgeA[i] = -sign * dy;
+		edgeB[i] = sign * dx;
+		edgeC[i] = sign * (dy * from.x - dx * from.y) - 0.5f * (fabsf(edgeA[i]) + fabsf(edgeB[i]));
+	}
+
+	// Depth is affine in screen space, the plane comes from the largest triangle of the fan for precision
+	int best = 1;
+	float bestDeterminant = 0.0f;
+	for (int i = 1; i + 1 < count; i++)
+	{
+		glm::vec3 first = points[i] - points[0];
+		glm::vec3 second = points[i + 1] - points[0];
+		float determinant = first.x * second.y - second.x * first.y;
+		if (fabsf(determinant) > fabsf(bestDeterminant))
+		{
+			best = i;
+			bestDeterminant = determinant;
+		}
+	}
+	glm::vec3 first = points[best] - points[0];
+	glm::vec3 second = points[best + 1] - points[0];
+	float depthA = (first.z * second.y - second.z * first.y) / bestDeterminant;
+	float depthB = (second.z * first.x - first.z * second.x) / bestDeterminant;
+	// The farthest the face gets inside the pixel
+	float depthC = points[0].z - depthA * points[0].x - depthB * points[0].y + 0.5f * (fabsf(depthA) + fabsf(depthB));
+
+#ifdef OCCLUSION_SSE2
+	__m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+	__m128 zero = _mm_setzero_ps();
+#endif
+	for (int y = startY; y < endY; y++)
+	{
+		float centerY = y + 0.5f;
+		float* row = &depth[y * WIDTH];
+		for (int x = startX; x < endX; x += 4)
+		{
+#ifdef OCCLUSION_SSE2
+			__m128 centerX = _mm_add_ps(_mm_set1_ps((float)x), laneOffsets);
+			__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (int i = 0; i < count; i++)
+			{
+				__m128 edge = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(edgeA[i]), centerX), _mm_set1_ps(edgeB[i] * centerY + edgeC[i]));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(edge, zero));
+			}
+			if (_mm_movemask_ps(inside) == 0)
+				continue;
+
+			__m128 faceDepth = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(depthA), centerX), _mm_set1_ps(depthB * centerY + depthC));
+			__m128 current = _mm_loadu_ps(row + x);
+			__m128 nearer = _mm_min_ps(current, faceDepth);
+			_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, current)));
+#else
+			for (int lane = 0; lane < 4; lane++)
+			{
+				float centerX = x + lane + 0.5f;
+				bool inside = true;
+				for (int i = 0; i < count && inside; i++)
+					inside = edgeA[i] * centerX + edgeB[i] * centerY + edgeC[i] >= 0.0f;
+				if (inside)
+					row[x + lane] = std::min(row[x + lane], depthA * centerX + depthB * centerY + depthC);
+			}
+#endif
+		}
+	}
+}
+
+static bool check(const char* name, bool passed)
+{
+	std::cout << (passed ? "  ok      " : "  FAILED  ") << name << '\n';
+	return passed;
+}
+
+bool OcclusionCuller::runBenchmark()
+{
+	// Same aspect as the depth buffer
+	glm::mat4 projection = glm::perspective(glm::radians(60.0f), (float)WIDTH / HEIGHT, 0.1f, 500.0f);
+	OcclusionCuller culler;
+	bool passed = true;
+
+	std::cout << "Occlusion culling checks\n";
+	{
+		glm::vec3 eye(0.0f);
+		culler.begin(projection * glm::lookAt(eye, glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f)), eye);
+		glm::vec3 wallMin(-5.0f, -5.0f, -12.0f), wallMax(5.0f, 5.0f, -10.0f);
+		culler.addOccluder(wallMin, wallMax);
+
+		passed &= check("box behind a wall is occluded", culler.isOccluded(glm::vec3(-1.0f, -1.0f, -30.0f), glm::vec3(1.0f, 1.0f, -28.0f)));
+		passed &= check("box in front of a wall is not", !culler.isOccluded(glm::vec3(-1.0f, -1.0f, -8.0f), glm::vec3(1.0f, 1.0f, -6.0f)));
+		passed &= check("box sticking out past a wall is not", !culler.isOccluded(glm::vec3(10.0f, -1.0f, -30.0f), glm::vec3(16.0f, 1.0f, -28.0f)));
+		passed &= check("occluder does not hide itself", !culler.isOccluded(wallMin, wallMax));
+		passed &= check("box behind the camera is outside the frustum", !culler.isInFrustum(glm::vec3(-1.0f, -1.0f, 5.0f), glm::vec3(1.0f, 1.0f, 7.0f)));
+		passed &= check("box ahead is inside the frustum", culler.isInFrustum(glm::vec3(-1.0f, -1.0f, -30.0f), glm::vec3(1.0f, 1.0f, -28.0f)));
+	}
+	{
+		// Looking down at a floor that reaches behind the camera, so it is clipped to the near plane
+		glm::vec3 eye(0.0f);
+		culler.begin(projection * glm::lookAt(eye, glm::vec3(0.0f, -1.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f)), eye);
+		culler.addOccluder(glm::vec3(-50.0f, -10.0f, -50.0f), glm::vec3(50.0f, -2.0f, 50.0f));
+
+		passed &= check("box under a clipped floor is occluded", culler.isOccluded(glm::vec3(-1.0f, -20.0f, -20.0f), glm::vec3(1.0f, -15.0f, -18.0f)));
+		passed &= check("box on a clipped floor is not", !culler.isOccluded(glm::vec3(-1.0f, -2.0f, -20.0f), glm::vec3(1.0f, 0.0f, -18.0f)));
+	}
+
+	// Generated terrain around the origin, each chunk occluding with its solid slab like in the game
+	const int range = 5;
+	const int height = 2;
+	glm::vec3 eye(0.5f, WorldGen::surfaceHeight(0, 0) + 2.0f, 0.5f);
+	int eyeChunkY = (int)floorf(eye.y / CHUNK_SIZE);
+	struct Box
+	{
+		glm::vec3 min;
+		int solidBottom, solidTop;
+		float distance;
+	};
+	std::vector<Box> boxes;
+	for (int x = -range; x <= range; x++)
+	{
+		for (int z = -range; z <= range; z++)
+		{
+			for (int y = eyeChunkY - height; y <= eyeChunkY + height; y++)
+			{
+				uint16_t* data = new uint16_t[CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE];
+				WorldGen::generateChunkData(ChunkPos(x, y, z), data);
+				ChunkData chunkData(data);
+				Box box;
+				chunkData.getSolidSlab(box.solidBottom, box.solidTop);
+
+				box.min = glm::vec3(x * (float)CHUNK_SIZE, y * (float)CHUNK_SIZE, z * (float)CHUNK_SIZE);
+				glm::vec3 toEye = eye - (box.min + glm::vec3(CHUNK_SIZE / 2.0f));
+				box.distance = glm::dot(toEye, toEye);
+				boxes.push_back(box);
+			}
+		}
+	}
+
+	const int directions = 8;
+	const int frames = 200;
+	unsigned int inFrustum = 0, occluded = 0, faces = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (int frame = 0; frame < directions * frames; frame++)
+	{
+		float yaw = (frame % directions) * glm::two_pi<float>() / directions;
+		glm::vec3 forward(cosf(yaw), -0.15f, sinf(yaw));
+		culler.begin(projection * glm::lookAt(eye, eye + forward, glm::vec3(0.0f, 1.0f, 0.0f)), eye);
+
+		std::vector<const Box*> occluders;
+		for (const Box& box : boxes)
+		{
+			if (box.solidTop > box.solidBottom)
+				occluders.push_back(&box);
+		}
+		size_t occluderCount = std::min<size_t>(occluders.size(), MAX_OCCLUDERS);
+		std::partial_sort(occluders.begin(), occluders.begin() + occluderCount, occluders.end(),
+			[](const Box* a, const Box* b) { return a->distance < b->distance; });
+		for (size_t i = 0; i < occluderCount; i++)
+		{
+			const Box& box = *occluders[i];
+			culler.addOccluder(box.min + glm::vec3(0.0f, box.solidBottom, 0.0f), box.min + glm::vec3(CHUNK_SIZE, box.solidTop, CHUNK_SIZE));
+		}
+		faces += culler.facesDrawn;
+
+		for (const Box& box : boxes)
+		{
+			glm::vec3 max = box.min + glm::vec3(CHUNK_SIZE);
+			if (!culler.isInFrustum(box.min, max))
+				continue;
+			inFrustum++;
+			if (culler.isOccluded(box.min, max))
+				occluded++;
+		}
+	}
+	double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	int totalFrames = directions * frames;
+
+	std::cout << "Terrain, " << boxes.size() << " chunks, " << WIDTH << "x" << HEIGHT << " depth buffer"
+#ifdef OCCLUSION_SSE2
+		<< ", SSE2"
+#endif
+		<< '\n'
+		<< "  " << milliseconds / totalFrames << " ms per frame, "
+		<< (float)faces / totalFrames << " occluder faces, "
+		<< (float)inFrustum / totalFrames << " chunks in frustum, "
+		<< (float)occluded / totalFrames << " of them occluded\n";
+
+	return passed;
+}
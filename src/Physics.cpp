@@ -6,6 +6,12 @@ Physics::RaycastResult Physics::raycast(const glm::vec3 startPos, const glm::vec
 {
 	float currentDistance = 0;
 
+	// Every chunk the ray can reach, looked up once instead of at each step. A block of margin covers the chunk
+	// rounding below for positions on a chunk border.
+	glm::vec3 endPos = startPos + direction * maxDistance;
+	std::vector<Chunk*> chunks;
+	Planet::planet->getChunksInBox(glm::min(startPos, endPos) - 1.0f, glm::max(startPos, endPos) + 1.0f, chunks);
+
 	while (currentDistance < maxDistance)
 	{
 		currentDistance += Physics::RAY_STEP;
@@ -17,7 +23,15 @@ Physics::RaycastResult Physics::raycast(const glm::vec3 startPos, const glm::vec
 		int chunkX = resultPos.x >= 0 ? resultPos.x / CHUNK_SIZE : resultPos.x / CHUNK_SIZE - 1;
 		int chunkY = resultPos.y >= 0 ? resultPos.y / CHUNK_SIZE : resultPos.y / CHUNK_SIZE - 1;
 		int chunkZ = resultPos.z >= 0 ? resultPos.z / CHUNK_SIZE : resultPos.z / CHUNK_SIZE - 1;
-		Chunk* chunk = Planet::planet->getChunk(ChunkPos(chunkX, chunkY, chunkZ));
+		Chunk* chunk = nullptr;
+		for (Chunk* candidate : chunks)
+		{
+			if (candidate->chunkPos == ChunkPos(chunkX, chunkY, chunkZ))
+			{
+				chunk = candidate;
+				break;
+			}
+		}
 		if (chunk == nullptr)
 			continue;
 
@@ -1,452 +1,496 @@
 #include "headers/Planet.h"
+#include <algorithm>
 #include <iostream>
 #include <GL/glew.h>
 #include "headers/WorldGen.h"
+#include "headers/Lighting.h"
+#include "headers/RandomTicks.h"
+#include "headers/Blocks.h"
 
 Planet *Planet::planet = nullptr;
 
+// Generates the blocks of a chunk and lights them
+static ChunkData* generateChunkData(ChunkPos chunkPos)
+{
+	uint16_t* d = new uint16_t[CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE];
+	WorldGen::generateChunkData(chunkPos, d);
+
+	ChunkData* data = new ChunkData(d);
+	Lighting::generateChunkLight(chunkPos, data);
+	return data;
+}
+
 // Public
 Planet::Planet(Shader* solidShader, Shader* waterShader, Shader* billboardShader)
-	: solidShader(solidShader), waterShader(waterShader), billboardShader(billboardShader)
+	: fluidSimulation(*this), renderDistanceGovernor(MIN_RENDER_DISTANCE, MAX_RENDER_DISTANCE, renderDistance), solidShader(solidShader), waterShader(waterShader), billboardShader(billboardShader),
+	streamer(jobSystem, chunkMutex, generateChunkData, [this](ChunkPos chunkPos) { finishChunk(chunkPos); }, true, LOAD_PRIORITY),
+	jobSystem(std::max(2u, std::thread::hardware_concurrency()) - 1)
 {
-	chunkThread = std::thread(&Planet::chunkThreadUpdate, this);
+	renderDistanceGovernor.setMemoryBudget(CHUNK_MEMORY_BUDGET);
 }
 
 Planet::~Planet()
 {
-	shouldEnd = true;
-	chunkThread.join();
+	jobSystem.waitIdle();
 }
 
-void Planet::update(glm::vec3 cameraPos)
+void Planet::update(glm::vec3 cameraPos, const glm::mat4& viewProjection)
 {
-	camChunkX = cameraPos.x < 0 ? floor(cameraPos.x / CHUNK_SIZE) : cameraPos.x / CHUNK_SIZE;
-	camChunkY = cameraPos.y < 0 ? floor(cameraPos.y / CHUNK_SIZE) : cameraPos.y / CHUNK_SIZE;
-	camChunkZ = cameraPos.z < 0 ? floor(cameraPos.z / CHUNK_SIZE) : cameraPos.z / CHUNK_SIZE;
+	setObserver(CAMERA_OBSERVER, cameraPos);
 
-	glDisable(GL_BLEND);
+	glCommandsExecuted = glCommands.execute(GL_COMMAND_BUDGET);
 
-	chunksLoading = 0;
-	numChunks = 0;
-	numChunksRendered = 0;
 	chunkMutex.lock();
-	for (auto it = chunks.begin(); it != chunks.end(); )
-	{
-		numChunks++;
+	unloadReleasedChunks();
+	dispatchChunkJobs();
 
-		if (!(*it->second).ready)
-			chunksLoading++;
+	occlusionCuller.begin(viewProjection, cameraPos);
+	addOccluders(cameraPos);
+	bool horizonCulling = buildHorizon(cameraPos);
 
-		int chunkX = (*it->second).chunkPos.x;
-		int chunkY = (*it->second).chunkPos.y;
-		int chunkZ = (*it->second).chunkPos.z;
-		if ((*it->second).ready && (abs(chunkX - camChunkX) > renderDistance ||
-			abs(chunkY - camChunkY) > renderDistance ||
-			abs(chunkZ - camChunkZ) > renderDistance))
+	numChunks = chunks.size();
+	numChunksRendered = 0;
+	numChunksOccluded = 0;
+	numChunksBelowHorizon = 0;
+	numCellsCulled = 0;
+	chunks.forEachCell([&](const ChunkIndex<Chunk*>::Cell& cell)
+	{
+		// Whole cells out of view or behind the occluders are dropped without looking at their chunks
+		if (!occlusionCuller.isInFrustum(cell.getMin(), cell.getMax()) || occlusionCuller.isOccluded(cell.getMin(), cell.getMax()))
 		{
-			// Out of range
-			// Add chunk data to delete queue
-			chunkDataDeleteQueue.emplace( chunkX,     chunkY, chunkZ );
-			chunkDataDeleteQueue.emplace( chunkX + 1, chunkY, chunkZ );
-			chunkDataDeleteQueue.emplace( chunkX - 1, chunkY, chunkZ );
-			chunkDataDeleteQueue.emplace( chunkX, chunkY + 1, chunkZ );
-			chunkDataDeleteQueue.emplace( chunkX, chunkY - 1, chunkZ );
-			chunkDataDeleteQueue.emplace( chunkX, chunkY, chunkZ + 1 );
-			chunkDataDeleteQueue.emplace( chunkX, chunkY, chunkZ - 1 );
-
-			// Delete chunk
-			delete it->second;
-			it = chunks.erase(it);
+			numCellsCulled++;
+			return;
 		}
-		else
+
+		ChunkIndex<Chunk*>::forEachInCell(cell, [&](Chunk* chunk)
 		{
-			numChunksRendered++;
-			(*it->second).render(solidShader, billboardShader);
-			++it;
-		}
+			queueChunk(chunk, cameraPos, horizonCulling);
+		});
+	});
+	chunkMutex.unlock();
+
+	renderQueue.draw();
+}
+
+// Culls the chunk and queues its draws if it is in view. Called with chunkMutex held.
+void Planet::queueChunk(Chunk* chunk, glm::vec3 cameraPos, bool horizonCulling)
+{
+	if (!chunk->ready)
+		return;
+
+	glm::vec3 min = glm::vec3(chunk->chunkPos.x, chunk->chunkPos.y, chunk->chunkPos.z) * (float)CHUNK_SIZE;
+	glm::vec3 max = min + glm::vec3(CHUNK_SIZE);
+	if (!occlusionCuller.isInFrustum(min, max))
+		return;
+	if (horizonCulling && horizonCuller.isHidden(chunk->chunkPos))
+	{
+		numChunksBelowHorizon++;
+		return;
+	}
+	if (occlusionCuller.isOccluded(min, max))
+	{
+		numChunksOccluded++;
+		return;
 	}
 
-	glEnable(GL_BLEND);
-	waterShader->use();
-	for (auto it = chunks.begin(); it != chunks.end(); )
+	numChunksRendered++;
+	chunk->queueDraws(renderQueue, solidShader, billboardShader, waterShader, cameraPos,
+		billboardDistance * (float)CHUNK_SIZE);
+}
+
+// Draws the solid slabs of the nearest chunks into the occlusion buffer. Called with chunkMutex held.
+void Planet::addOccluders(glm::vec3 cameraPos)
+{
+	occluders.clear();
+	chunks.forEachInRadius(cameraPos, OCCLUDER_RADIUS, [&](Chunk* chunk)
 	{
-		int chunkX = (*it->second).chunkPos.x;
-		int chunkY = (*it->second).chunkPos.y;
-		int chunkZ = (*it->second).chunkPos.z;
+		if (!chunk->ready || chunk->solidTop == chunk->solidBottom)
+			return;
+
+		glm::vec3 toCamera = cameraPos - (glm::vec3(chunk->chunkPos.x, chunk->chunkPos.y, chunk->chunkPos.z) + 0.5f) * (float)CHUNK_SIZE;
+		occluders.push_back({ glm::dot(toCamera, toCamera), chunk });
+	});
+
+	size_t count = std::min<size_t>(occluders.size(), OcclusionCuller::MAX_OCCLUDERS);
+	std::partial_sort(occluders.begin(), occluders.begin() + count, occluders.end(),
+		[](const std::pair<float, Chunk*>& a, const std::pair<float, Chunk*>& b) { return a.first < b.first; });
 
-		(*it->second).renderWater(waterShader);
-		++it;
+	for (size_t i = 0; i < count; i++)
+	{
+		Chunk* chunk = occluders[i].second;
+		glm::vec3 min = glm::vec3(chunk->chunkPos.x, chunk->chunkPos.y, chunk->chunkPos.z) * (float)CHUNK_SIZE;
+		occlusionCuller.addOccluder(min + glm::vec3(0.0f, chunk->solidBottom, 0.0f), min + glm::vec3(CHUNK_SIZE, chunk->solidTop, CHUNK_SIZE));
 	}
+}
 
-	chunkMutex.unlock();
+// Builds the horizon from the ground of the chunk columns around the camera, false if the camera is under cover
+// and the horizon can't be used. Called with chunkMutex held.
+bool Planet::buildHorizon(glm::vec3 cameraPos)
+{
+	ChunkPos cameraChunk((int)floorf(cameraPos.x / CHUNK_SIZE), (int)floorf(cameraPos.y / CHUNK_SIZE), (int)floorf(cameraPos.z / CHUNK_SIZE));
+	int localX = (int)floorf(cameraPos.x) - cameraChunk.x * CHUNK_SIZE;
+	int localZ = (int)floorf(cameraPos.z) - cameraChunk.z * CHUNK_SIZE;
+
+	// Every block above the camera up to the top of the loaded area must be known and not opaque
+	for (int chunkY = cameraChunk.y; chunkY <= cameraChunk.y + renderHeight; chunkY++)
+	{
+		Chunk* chunk = chunks.find({ cameraChunk.x, chunkY, cameraChunk.z });
+		if (chunk == nullptr || !chunk->ready)
+			return false;
+
+		int startY = chunkY == cameraChunk.y ? (int)floorf(cameraPos.y) - chunkY * CHUNK_SIZE : 0;
+		for (int y = std::max(startY, 0); y < CHUNK_SIZE; y++)
+		{
+			if (Blocks::blocks[chunk->chunkData->getBlock(localX, y, localZ)].blockType == Block::SOLID)
+				return false;
+		}
+	}
+
+	int size = renderDistance * 2 + 1;
+	groundHeights.assign(size * size, -INFINITY);
+	glm::vec3 gridMin = glm::vec3(cameraChunk.x - renderDistance, cameraChunk.y - renderHeight, cameraChunk.z - renderDistance) * (float)CHUNK_SIZE;
+	glm::vec3 gridMax = gridMin + glm::vec3(size, renderHeight * 2 + 1, size) * (float)CHUNK_SIZE - 1.0f;
+	chunks.forEachInBox(gridMin, gridMax, [&](Chunk* chunk)
+	{
+		if (!chunk->ready || chunk->groundHeight == 0)
+			return;
+
+		int x = chunk->chunkPos.x - cameraChunk.x + renderDistance;
+		int z = chunk->chunkPos.z - cameraChunk.z + renderDistance;
+		float& ground = groundHeights[x * size + z];
+		ground = std::max(ground, chunk->chunkPos.y * (float)CHUNK_SIZE + chunk->groundHeight);
+	});
+
+	horizonCuller.build(cameraPos, cameraChunk.x - renderDistance, cameraChunk.z - renderDistance, size, groundHeights);
+	return true;
 }
 
-void Planet::chunkThreadUpdate()
+// Starts jobs for queued remeshes and the nearest chunks that still need loading. Called with chunkMutex held.
+void Planet::dispatchChunkJobs()
 {
-	while (!shouldEnd)
+	// Rebuild meshes of edited chunks, one that is still remeshing waits for a later frame
+	std::vector<ChunkPos> waiting;
+	while (!remeshQueue.empty())
 	{
-		for (auto it = chunkData.begin(); it != chunkData.end(); )
+		Chunk* chunk = chunks.find(remeshQueue.front());
+		remeshQueue.pop();
+		if (chunk == nullptr || !chunk->ready)
+			continue;
+
+		if (chunk->remeshing)
 		{
-			ChunkPos pos = it->first;
-
-			if (chunks.find(pos) == chunks.end() &&
-				chunks.find({ pos.x + 1, pos.y, pos.z }) == chunks.end() &&
-				chunks.find({ pos.x - 1, pos.y, pos.z }) == chunks.end() &&
-				chunks.find({ pos.x, pos.y + 1, pos.z }) == chunks.end() &&
-				chunks.find({ pos.x, pos.y - 1, pos.z }) == chunks.end() &&
-				chunks.find({ pos.x, pos.y, pos.z + 1 }) == chunks.end() &&
-				chunks.find({ pos.x, pos.y, pos.z - 1 }) == chunks.end())
-			{
-				delete chunkData.at(pos);
-				it = chunkData.erase(it);
-			}
-			else {
-				++it;
-			}
+			waiting.push_back(chunk->chunkPos);
+			continue;
 		}
 
-		// Check if camera moved to new chunk
-		if (camChunkX != lastCamX || camChunkY != lastCamY || camChunkZ != lastCamZ)
+		chunk->remeshing = true;
+		JobHandle remeshJob = jobSystem.createJob([this, chunk]()
 		{
-			// Player moved chunks, start new chunk queue
-			lastCamX = camChunkX;
-			lastCamY = camChunkY;
-			lastCamZ = camChunkZ;
+			chunk->remesh();
+			queueUpload(chunk);
 
-			// Current chunk
 			chunkMutex.lock();
-			chunkQueue = {};
-			if (chunks.find({ camChunkX, camChunkY, camChunkZ }) == chunks.end())
-				chunkQueue.emplace( camChunkX, camChunkY, camChunkZ );
+			chunk->remeshing = false;
+			chunkMutex.unlock();
+		});
+		remeshJob->priority = REMESH_PRIORITY;
+		jobSystem.submit(remeshJob);
+	}
+	for (const ChunkPos& chunkPos : waiting)
+		remeshQueue.push(chunkPos);
 
-			for (int r = 0; r < renderDistance; r++)
-			{
-				// Add middle chunks
-				for (int y = 0; y <= renderHeight; y++)
-				{
-					chunkQueue.emplace( camChunkX,     camChunkY + y, camChunkZ + r );
-					chunkQueue.emplace( camChunkX + r, camChunkY + y, camChunkZ );
-					chunkQueue.emplace( camChunkX,     camChunkY + y, camChunkZ - r );
-					chunkQueue.emplace( camChunkX - r, camChunkY + y, camChunkZ );
-
-					if (y > 0)
-					{
-						chunkQueue.emplace( camChunkX,     camChunkY - y, camChunkZ + r );
-						chunkQueue.emplace( camChunkX + r, camChunkY - y, camChunkZ );
-						chunkQueue.emplace( camChunkX,     camChunkY - y, camChunkZ - r );
-						chunkQueue.emplace( camChunkX - r, camChunkY - y, camChunkZ);
-					}
-				}
-
-				// Add edges
-				for (int e = 1; e < r; e++)
-				{
-					for (int y = 0; y <= renderHeight; y++)
-					{
-						chunkQueue.emplace( camChunkX + e, camChunkY + y, camChunkZ + r );
-						chunkQueue.emplace( camChunkX - e, camChunkY + y, camChunkZ + r );
-						chunkQueue.emplace( camChunkX + r, camChunkY + y, camChunkZ + e );
-						chunkQueue.emplace( camChunkX + r, camChunkY + y, camChunkZ - e );
-						chunkQueue.emplace( camChunkX + e, camChunkY + y, camChunkZ - r );
-						chunkQueue.emplace( camChunkX - e, camChunkY + y, camChunkZ - r );
-						chunkQueue.emplace( camChunkX - r, camChunkY + y, camChunkZ + e );
-						chunkQueue.emplace( camChunkX - r, camChunkY + y, camChunkZ - e );
-
-						if (y > 0)
-						{
-							chunkQueue.emplace( camChunkX + e, camChunkY - y, camChunkZ + r );
-							chunkQueue.emplace( camChunkX - e, camChunkY - y, camChunkZ + r );
-							chunkQueue.emplace( camChunkX + r, camChunkY - y, camChunkZ + e );
-							chunkQueue.emplace( camChunkX + r, camChunkY - y, camChunkZ - e );
-							chunkQueue.emplace( camChunkX + e, camChunkY - y, camChunkZ - r );
-							chunkQueue.emplace( camChunkX - e, camChunkY - y, camChunkZ - r );
-							chunkQueue.emplace( camChunkX - r, camChunkY - y, camChunkZ + e );
-							chunkQueue.emplace( camChunkX - r, camChunkY - y, camChunkZ - e );
-						}
-					}
-				}
-
-				// Add corners
-				for (int y = 0; y <= renderHeight; y++)
-				{
-					chunkQueue.emplace( camChunkX + r, camChunkY + y, camChunkZ + r );
-					chunkQueue.emplace( camChunkX + r, camChunkY + y, camChunkZ - r );
-					chunkQueue.emplace( camChunkX - r, camChunkY + y, camChunkZ + r );
-					chunkQueue.emplace( camChunkX - r, camChunkY + y, camChunkZ - r );
-
-					if (y > 0)
-					{
-						chunkQueue.emplace( camChunkX + r, camChunkY - y, camChunkZ + r );
-						chunkQueue.emplace( camChunkX + r, camChunkY - y, camChunkZ - r );
-						chunkQueue.emplace( camChunkX - r, camChunkY - y, camChunkZ + r );
-						chunkQueue.emplace( camChunkX - r, camChunkY - y, camChunkZ - r );
-					}
-				}
-			}
+	streamer.dispatch();
+}
 
-			chunkMutex.unlock();
-		}
-		else
+// Meshes a chunk once its data and its neighbours' data exist, on a job worker
+void Planet::finishChunk(ChunkPos chunkPos)
+{
+	Chunk* chunk = new Chunk(chunkPos, solidShader, waterShader);
+
+	chunkMutex.lock();
+	chunk->chunkData = streamer.getData(chunkPos);
+	chunk->upData = streamer.getData({ chunkPos.x, chunkPos.y + 1, chunkPos.z });
+	chunk->downData = streamer.getData({ chunkPos.x, chunkPos.y - 1, chunkPos.z });
+	chunk->northData = streamer.getData({ chunkPos.x, chunkPos.y, chunkPos.z - 1 });
+	chunk->southData = streamer.getData({ chunkPos.x, chunkPos.y, chunkPos.z + 1 });
+	chunk->eastData = streamer.getData({ chunkPos.x + 1, chunkPos.y, chunkPos.z });
+	chunk->westData = streamer.getData({ chunkPos.x - 1, chunkPos.y, chunkPos.z });
+	chunkMutex.unlock();
+
+	chunk->generateChunkMesh();
+
+	// Publish, a chunk every observer left while it was loading is unloaded with the released ones. The upload is
+	// queued before the lock is released, so the render thread's delete of an unloaded chunk always comes after it.
+	chunkMutex.lock();
+	chunks.insert(chunkPos, chunk);
+	streamer.finishLoading(chunkPos);
+	queueUpload(chunk);
+	chunkMutex.unlock();
+}
+
+Chunk* Planet::getChunk(ChunkPos chunkPos)
+{
+	chunkMutex.lock();
+	Chunk* chunk = chunks.find(chunkPos);
+	chunkMutex.unlock();
+	return chunk;
+}
+
+ChunkData* Planet::getChunkData(ChunkPos chunkPos)
+{
+	chunkMutex.lock();
+	ChunkData* data = streamer.getData(chunkPos);
+	chunkMutex.unlock();
+	return data;
+}
+
+Lighting::ChunkDataLookup Planet::getLightLookup()
+{
+	return [this](ChunkPos chunkPos)
+	{
+		return getChunkData(chunkPos);
+	};
+}
+
+WorldEdit::EditTarget Planet::getEditTarget()
+{
+	return {
+		[this](ChunkPos chunkPos) -> ChunkData*
+		{
+			Chunk* chunk = getChunk(chunkPos);
+			return chunk != nullptr && chunk->ready ? chunk->chunkData : nullptr;
+		},
+		[this](glm::ivec3 min, glm::ivec3 max, std::vector<std::pair<ChunkPos, ChunkData*>>& out)
 		{
 			chunkMutex.lock();
-			if (!chunkDataQueue.empty())
+			chunks.forEachInBox(glm::vec3(min), glm::vec3(max), [&out](Chunk* chunk)
 			{
-				ChunkPos chunkPos = chunkDataQueue.front();
+				if (chunk->ready)
+					out.emplace_back(chunk->chunkPos, chunk->chunkData);
+			});
+			chunkMutex.unlock();
+		},
+		[this](ChunkPos chunkPos)
+		{
+			queueRemesh(chunkPos);
+		},
+		[this](int x, int y, int z)
+		{
+			fluidSimulation.blockChanged(x, y, z);
+		}
+	};
+}
 
-				if (chunkData.find(chunkPos) != chunkData.end())
-				{
-					chunkDataQueue.pop();
-					chunkMutex.unlock();
-					continue;
-				}
+void Planet::getChunksInBox(glm::vec3 min, glm::vec3 max, std::vector<Chunk*>& out)
+{
+	chunkMutex.lock();
+	chunks.forEachInBox(min, max, [&out](Chunk* chunk)
+	{
+		out.push_back(chunk);
+	});
+	chunkMutex.unlock();
+}
 
-				chunkMutex.unlock();
+void Planet::setObserver(int id, glm::vec3 position)
+{
+	ChunkPos center(
+		(int)floorf(position.x / CHUNK_SIZE),
+		(int)floorf(position.y / CHUNK_SIZE),
+		(int)floorf(position.z / CHUNK_SIZE));
 
-				uint16_t* d = new uint16_t[CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE];
-				ChunkData* data = new ChunkData(d);
+	chunkMutex.lock();
+	streamer.setRange(renderDistance, renderHeight);
+	streamer.setObserver(id, center);
+	chunkMutex.unlock();
+}
 
-				WorldGen::generateChunkData(chunkPos, d);
+void Planet::removeObserver(int id)
+{
+	chunkMutex.lock();
+	streamer.removeObserver(id);
+	chunkMutex.unlock();
+}
 
-				chunkMutex.lock();
-				chunkData[chunkPos] = data;
-				chunkDataQueue.pop();
-				chunkMutex.unlock();
-			}
-			else
-			{
-				if (!chunkQueue.empty())
-				{
-					// Check if chunk exists
-					ChunkPos chunkPos = chunkQueue.front();
-					if (chunks.find(chunkPos) != chunks.end())
-					{
-						chunkQueue.pop();
-						chunkMutex.unlock();
-						continue;
-					}
-
-					chunkMutex.unlock();
-
-					// Create chunk object
-					Chunk* chunk = new Chunk(chunkPos, solidShader, waterShader);
-
-					// Set chunk data
-					{
-						chunkMutex.lock();
-						if (chunkData.find(chunkPos) == chunkData.end())
-						{
-							chunkMutex.unlock();
-							uint16_t* d = new uint16_t[CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE];
-
-							WorldGen::generateChunkData(chunkPos, d);
-
-							ChunkData* data = new ChunkData(d);
-
-							chunk->chunkData = data;
-
-							chunkMutex.lock();
-							chunkData[chunkPos] = data;
-							chunkMutex.unlock();
-						}
-						else
-						{
-							chunk->chunkData = chunkData.at(chunkPos);
-							chunkMutex.unlock();
-						}
-					}
-
-					// Set top data
-					{
-						ChunkPos topPos(chunkPos.x, chunkPos.y + 1, chunkPos.z);
-						chunkMutex.lock();
-						if (chunkData.find(topPos) == chunkData.end())
-						{
-							chunkMutex.unlock();
-							uint16_t* d = new uint16_t[CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE];
-
-							WorldGen::generateChunkData(topPos, d);
-
-							ChunkData* data = new ChunkData(d);
-
-							chunk->upData = data;
-
-							chunkMutex.lock();
-							chunkData[topPos] = data;
-							chunkMutex.unlock();
-						}
-						else
-						{
-							chunk->upData = chunkData.at(topPos);
-							chunkMutex.unlock();
-						}
-					}
-
-					// Set bottom data
-					{
-						ChunkPos bottomPos(chunkPos.x, chunkPos.y - 1, chunkPos.z);
-						chunkMutex.lock();
-						if (chunkData.find(bottomPos) == chunkData.end())
-						{
-							chunkMutex.unlock();
-							uint16_t* d = new uint16_t[CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE];
-
-							WorldGen::generateChunkData(bottomPos, d);
-
-							ChunkData* data = new ChunkData(d);
-
-							chunk->downData = data;
-
-							chunkMutex.lock();
-							chunkData[bottomPos] = data;
-							chunkMutex.unlock();
-						}
-						else
-						{
-							chunk->downData = chunkData.at(bottomPos);
-							chunkMutex.unlock();
-						}
-					}
-
-					// Set north data
-					{
-						ChunkPos northPos(chunkPos.x, chunkPos.y, chunkPos.z - 1);
-						chunkMutex.lock();
-						if (chunkData.find(northPos) == chunkData.end())
-						{
-							chunkMutex.unlock();
-							uint16_t* d = new uint16_t[CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE];
-
-							WorldGen::generateChunkData(northPos, d);
-
-							ChunkData* data = new ChunkData(d);
-
-							chunk->northData = data;
-
-							chunkMutex.lock();
-							chunkData[northPos] = data;
-							chunkMutex.unlock();
-						}
-						else
-						{
-							chunk->northData = chunkData.at(northPos);
-							chunkMutex.unlock();
-						}
-					}
-
-					// Set south data
-					{
-						ChunkPos southPos(chunkPos.x, chunkPos.y, chunkPos.z + 1);
-						chunkMutex.lock();
-						if (chunkData.find(southPos) == chunkData.end())
-						{
-							chunkMutex.unlock();
-							uint16_t* d = new uint16_t[CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE];
-
-							WorldGen::generateChunkData(southPos, d);
-
-							ChunkData* data = new ChunkData(d);
-
-							chunk->southData = data;
-
-							chunkMutex.lock();
-							chunkData[southPos] = data;
-							chunkMutex.unlock();
-						}
-						else
-						{
-							chunk->southData = chunkData.at(southPos);
-							chunkMutex.unlock();
-						}
-					}
-
-					// Set east data
-					{
-						ChunkPos eastPos(chunkPos.x + 1, chunkPos.y, chunkPos.z);
-						chunkMutex.lock();
-						if (chunkData.find(eastPos) == chunkData.end())
-						{
-							chunkMutex.unlock();
-							uint16_t* d = new uint16_t[CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE];
-
-							WorldGen::generateChunkData(eastPos, d);
-
-							ChunkData* data = new ChunkData(d);
-
-							chunk->eastData = data;
-
-							chunkMutex.lock();
-							chunkData[eastPos] = data;
-							chunkMutex.unlock();
-						}
-						else
-						{
-							chunk->eastData = chunkData.at(eastPos);
-							chunkMutex.unlock();
-						}
-					}
-
-					// Set west data
-					{
-						ChunkPos westPos(chunkPos.x - 1, chunkPos.y, chunkPos.z);
-						chunkMutex.lock();
-						if (chunkData.find(westPos) == chunkData.end())
-						{
-							chunkMutex.unlock();
-							uint16_t* d = new uint16_t[CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE];
-
-							WorldGen::generateChunkData(westPos, d);
-
-							ChunkData* data = new ChunkData(d);
-
-							chunk->westData = data;
-
-							chunkMutex.lock();
-							chunkData[westPos] = data;
-							chunkMutex.unlock();
-						}
-						else
-						{
-							chunk->westData = chunkData.at(westPos);
-							chunkMutex.unlock();
-						}
-					}
-
-					// Generate chunk mesh
-					chunk->generateChunkMesh();
-
-					// Finish
-					chunkMutex.lock();
-					chunks[chunkPos] = chunk;
-					chunkQueue.pop();
-					chunkMutex.unlock();
-				}
-				else
-				{
-					chunkMutex.unlock();
-
-					std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-				}
-			}
+bool Planet::getBlock(int x, int y, int z, uint16_t& block)
+{
+	int chunkX = x < 0 ? floorf(x / (float)CHUNK_SIZE) : x / (int)CHUNK_SIZE;
+	int chunkY = y < 0 ? floorf(y / (float)CHUNK_SIZE) : y / (int)CHUNK_SIZE;
+	int chunkZ = z < 0 ? floorf(z / (float)CHUNK_SIZE) : z / (int)CHUNK_SIZE;
+
+	Chunk* chunk = getChunk({ chunkX, chunkY, chunkZ });
+	if (chunk == nullptr || !chunk->ready)
+		return false;
+
+	block = chunk->chunkData->getBlock(x - chunkX * CHUNK_SIZE, y - chunkY * CHUNK_SIZE, z - chunkZ * CHUNK_SIZE);
+	return true;
+}
+
+bool Planet::setBlock(int x, int y, int z, uint16_t block)
+{
+	int chunkX = x < 0 ? floorf(x / (float)CHUNK_SIZE) : x / (int)CHUNK_SIZE;
+	int chunkY = y < 0 ? floorf(y / (float)CHUNK_SIZE) : y / (int)CHUNK_SIZE;
+	int chunkZ = z < 0 ? floorf(z / (float)CHUNK_SIZE) : z / (int)CHUNK_SIZE;
+
+	Chunk* chunk = getChunk({ chunkX, chunkY, chunkZ });
+	if (chunk == nullptr || !chunk->ready)
+		return false;
+
+	int localX = x - chunkX * CHUNK_SIZE;
+	int localY = y - chunkY * CHUNK_SIZE;
+	int localZ = z - chunkZ * CHUNK_SIZE;
+	chunk->chunkData->setBlock(localX, localY, localZ, block);
+	std::vector<ChunkPos> relitChunks;
+	lightUpdateVoxels = Lighting::updateBlock(chunk->chunkPos, getLightLookup(), localX, localY, localZ, relitChunks);
+
+	// Border blocks show up in the neighbour's mesh too, as do the chunks the light change spread into
+	dirtyChunks.insert(relitChunks.begin(), relitChunks.end());
+	dirtyChunks.insert({ chunkX, chunkY, chunkZ });
+	if (localX == 0)
+		dirtyChunks.insert({ chunkX - 1, chunkY, chunkZ });
+	else if (localX == CHUNK_SIZE - 1)
+		dirtyChunks.insert({ chunkX + 1, chunkY, chunkZ });
+	if (localY == 0)
+		dirtyChunks.insert({ chunkX, chunkY - 1, chunkZ });
+	else if (localY == CHUNK_SIZE - 1)
+		dirtyChunks.insert({ chunkX, chunkY + 1, chunkZ });
+	if (localZ == 0)
+		dirtyChunks.insert({ chunkX, chunkY, chunkZ - 1 });
+	else if (localZ == CHUNK_SIZE - 1)
+		dirtyChunks.insert({ chunkX, chunkY, chunkZ + 1 });
+
+	return true;
+}
+
+uint8_t Planet::getFlowLevel(int x, int y, int z)
+{
+	int chunkX = x < 0 ? floorf(x / (float)CHUNK_SIZE) : x / (int)CHUNK_SIZE;
+	int chunkY = y < 0 ? floorf(y / (float)CHUNK_SIZE) : y / (int)CHUNK_SIZE;
+	int chunkZ = z < 0 ? floorf(z / (float)CHUNK_SIZE) : z / (int)CHUNK_SIZE;
+
+	Chunk* chunk = getChunk({ chunkX, chunkY, chunkZ });
+	if (chunk == nullptr || !chunk->ready)
+		return 0;
+
+	return chunk->chunkData->getFlowLevel(x - chunkX * CHUNK_SIZE, y - chunkY * CHUNK_SIZE, z - chunkZ * CHUNK_SIZE);
+}
+
+// Levels only change with the block, whose setBlock already queued the remesh
+bool Planet::setFlowLevel(int x, int y, int z, uint8_t level)
+{
+	int chunkX = x < 0 ? floorf(x / (float)CHUNK_SIZE) : x / (int)CHUNK_SIZE;
+	int chunkY = y < 0 ? floorf(y / (float)CHUNK_SIZE) : y / (int)CHUNK_SIZE;
+	int chunkZ = z < 0 ? floorf(z / (float)CHUNK_SIZE) : z / (int)CHUNK_SIZE;
+
+	Chunk* chunk = getChunk({ chunkX, chunkY, chunkZ });
+	if (chunk == nullptr || !chunk->ready)
+		return false;
+
+	chunk->chunkData->setFlowLevel(x - chunkX * CHUNK_SIZE, y - chunkY * CHUNK_SIZE, z - chunkZ * CHUNK_SIZE, level);
+	return true;
+}
+
+// Unloads the chunks no observer holds anymore, those still being remeshed wait for a later frame.
+// Called with chunkMutex held.
+void Planet::unloadReleasedChunks()
+{
+	streamer.takeReleased(unloadQueue);
+
+	for (auto it = unloadQueue.begin(); it != unloadQueue.end(); )
+	{
+		Chunk* chunk = chunks.find(*it);
+		if (chunk == nullptr || streamer.reclaim(*it))
+		{
+			it = unloadQueue.erase(it);
+			continue;
+		}
+
+		if (chunk->remeshing)
+		{
+			++it;
+			continue;
 		}
+
+		// Deleted on the render thread after any upload queued before it
+		glCommands.submit([chunk]()
+		{
+			delete chunk;
+		});
+		chunks.erase(*it);
+		streamer.unload(*it);
+		it = unloadQueue.erase(it);
 	}
 }
 
-Chunk* Planet::getChunk(ChunkPos chunkPos)
+// Uploads the chunk's mesh on the render thread, trying again next frame if a remesh is writing it.
+// No remesh starts once a chunk is unloaded, so a retry can't be queued behind the chunk's deletion.
+void Planet::queueUpload(Chunk* chunk)
 {
-	chunkMutex.lock();
-	if (chunks.find(chunkPos) == chunks.end())
+	glCommands.submit([this, chunk]()
 	{
-		chunkMutex.unlock();
-		return nullptr;
-	}
-	else
+		if (!chunk->tryUploadMesh())
+			queueUpload(chunk);
+	});
+}
+
+void Planet::updateTicks(float deltaTime)
+{
+	tickTime += deltaTime;
+
+	// Drop time we can't catch up on instead of stalling frames
+	if (tickTime > 4 * TICK_LENGTH)
+		tickTime = 4 * TICK_LENGTH;
+
+	while (tickTime >= TICK_LENGTH)
 	{
-		chunkMutex.unlock();
-		return chunks.at(chunkPos);
+		tickTime -= TICK_LENGTH;
+
+		fluidSimulation.tick();
+		randomTick();
+		remeshDirtyChunks();
 	}
 }
 
-void Planet::clearChunkQueue()
+void Planet::updateRenderDistance(float frameTime)
 {
-	lastCamX++;
+	chunkMutex.lock();
+	unsigned int backlog = streamer.getBacklog() + (unsigned int)remeshQueue.size();
+	size_t memoryBytes = streamer.getAllData().size() * CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE * (sizeof(uint16_t) + sizeof(uint8_t));
+	chunkMutex.unlock();
+
+	// Uploads waiting for the render thread are part of the backlog too
+	backlog += glCommands.getPendingCount();
+	renderDistanceGovernor.update(frameTime, backlog, memoryBytes);
+
+	// The new range takes effect with the next observer update
+	renderDistance = renderDistanceGovernor.getDistance();
+}
+
+void Planet::randomTick()
+{
+	// Chunks are only deleted on this thread, so the pointers stay valid while ticking
+	std::vector<Chunk*> readyChunks;
+	chunkMutex.lock();
+	chunks.forEach([&readyChunks](Chunk* chunk)
+	{
+		if (chunk->ready)
+			readyChunks.push_back(chunk);
+	});
+	chunkMutex.unlock();
+
+	for (Chunk* chunk : readyChunks)
+		RandomTicks::tickChunk(*this, chunk->chunkPos, chunk->chunkData);
+}
+
+void Planet::remeshDirtyChunks()
+{
+	for (const ChunkPos& chunkPos : dirtyChunks)
+		queueRemesh(chunkPos);
+	dirtyChunks.clear();
+}
+
+void Planet::queueRemesh(ChunkPos chunkPos)
+{
+	chunkMutex.lock();
+	remeshQueue.push(chunkPos);
+	chunkMutex.unlock();
 }
\ No newline at end of file
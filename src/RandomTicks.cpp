@@ -0,0 +1,133 @@
+#include "headers/RandomTicks.h"
+
+#include "headers/Blocks.h"
+
+// xorshift32, one stream per thread
+static uint32_t nextRandom()
+{
+	thread_local uint32_t state = 2463534242u;
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+static bool isOpaque(uint16_t block)
+{
+	Block::BLOCK_TYPE blockType = Blocks::blocks[block].blockType;
+	return blockType == Block::SOLID || blockType == Block::LIQUID;
+}
+
+static bool isFlower(uint16_t block)
+{
+	return block == Blocks::POPPY || block == Blocks::WHITE_TULIP || block == Blocks::PINK_TULIP || block == Blocks::ORANGE_TULIP;
+}
+
+bool RandomTicks::isTickable(uint16_t block)
+{
+	return block == Blocks::GRASS_BLOCK || block == Blocks::LEAVES || block == Blocks::GRASS || isFlower(block);
+}
+
+// Grass dies under opaque blocks and otherwise spreads to nearby dirt that has room above it
+static void tickGrassBlock(BlockAccess& world, int x, int y, int z)
+{
+	uint16_t above;
+	if (world.getBlock(x, y + 1, z, above) && isOpaque(above))
+	{
+		world.setBlock(x, y, z, Blocks::DIRT_BLOCK);
+		return;
+	}
+
+	uint32_t random = nextRandom();
+	int targetX = x + (int)(random % 3) - 1;
+	int targetY = y + (int)((random >> 8) % 3) - 1;
+	int targetZ = z + (int)((random >> 16) % 3) - 1;
+
+	uint16_t target, targetAbove;
+	if (world.getBlock(targetX, targetY, targetZ, target) && target == Blocks::DIRT_BLOCK
+		&& world.getBlock(targetX, targetY + 1, targetZ, targetAbove) && !isOpaque(targetAbove))
+		world.setBlock(targetX, targetY, targetZ, Blocks::GRASS_BLOCK);
+}
+
+static void tickLeaves(BlockAccess& world, int x, int y, int z)
+{
+	const int distance = RandomTicks::LEAF_DECAY_DISTANCE;
+	for (int dX = -distance; dX <= distance; dX++)
+	{
+		for (int dZ = -distance; dZ <= distance; dZ++)
+		{
+			for (int dY = -distance; dY <= distance; dY++)
+			{
+				// Unloaded neighbours might hold the log, keep the leaves until we know
+				uint16_t block;
+				if (!world.getBlock(x + dX, y + dY, z + dZ, block) || block == Blocks::LOG)
+					return;
+			}
+		}
+	}
+
+	world.setBlock(x, y, z, Blocks::AIR);
+}
+
+// Short grass sometimes grows into tall grass
+static void tickGrass(BlockAccess& world, int x, int y, int z)
+{
+	if (nextRandom() % 8 != 0)
+		return;
+
+	uint16_t above;
+	if (world.getBlock(x, y + 1, z, above) && above == Blocks::AIR)
+	{
+		world.setBlock(x, y, z, Blocks::TALL_GRASS_BOTTOM);
+		world.setBlock(x, y + 1, z, Blocks::TALL_GRASS_TOP);
+	}
+}
+
+// Flowers sometimes seed a copy onto nearby open grass
+static void tickFlower(BlockAccess& world, int x, int y, int z, uint16_t flower)
+{
+	uint32_t random = nextRandom();
+	if (random % 16 != 0)
+		return;
+
+	int targetX = x + (int)((random >> 4) % 5) - 2;
+	int targetZ = z + (int)((random >> 12) % 5) - 2;
+
+	uint16_t target, below;
+	if (world.getBlock(targetX, y, targetZ, target) && target == Blocks::AIR
+		&& world.getBlock(targetX, y - 1, targetZ, below) && below == Blocks::GRASS_BLOCK)
+		world.setBlock(targetX, y, targetZ, flower);
+}
+
+void RandomTicks::tickChunk(BlockAccess& world, ChunkPos chunkPos, ChunkData* chunkData)
+{
+	for (int section = 0; section < SECTION_COUNT; section++)
+	{
+		if (chunkData->tickableCounts[section] == 0)
+			continue;
+
+		for (int i = 0; i < TICKS_PER_SECTION; i++)
+		{
+			uint32_t random = nextRandom();
+			int localX = random % CHUNK_SIZE;
+			int localY = section * SECTION_HEIGHT + (random >> 5) % SECTION_HEIGHT;
+			int localZ = (random >> 8) % CHUNK_SIZE;
+
+			uint16_t block = chunkData->getBlock(localX, localY, localZ);
+			if (!isTickable(block))
+				continue;
+
+			int x = chunkPos.x * (int)CHUNK_SIZE + localX;
+			int y = chunkPos.y * (int)CHUNK_SIZE + localY;
+			int z = chunkPos.z * (int)CHUNK_SIZE + localZ;
+			if (block == Blocks::GRASS_BLOCK)
+				tickGrassBlock(world, x, y, z);
+			else if (block == Blocks::LEAVES)
+				tickLeaves(world, x, y, z);
+			else if (block == Blocks::GRASS)
+				tickGrass(world, x, y, z);
+			else
+				tickFlower(world, x, y, z, block);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,229 @@
+#include "headers/RenderDistanceGovernor.h"
+#include <algorithm>
+#include <iostream>
+#include <random>
+
+RenderDistanceGovernor::RenderDistanceGovernor(int minDistance, int maxDistance, int distance)
+	: minDistance(minDistance), maxDistance(maxDistance), distance(std::clamp(distance, minDistance, maxDistance))
+{
+
+}
+
+void RenderDistanceGovernor::setTargetFps(float fps)
+{
+	targetFrameTime = 1000.0f / std::max(fps, 1.0f);
+}
+
+void RenderDistanceGovernor::setMemoryBudget(size_t bytes)
+{
+	memoryBudget = bytes;
+}
+
+bool RenderDistanceGovernor::update(float frameTime, unsigned int backlog, size_t memoryBytes)
+{
+	totalTime += frameTime;
+	windowTime += frameTime;
+	windowFrames++;
+	if (windowTime < WINDOW_LENGTH)
+		return false;
+
+	averageFrameTime = windowTime / windowFrames;
+	windowTime = 0.0f;
+	windowFrames = 0;
+
+	int lastDistance = distance;
+	evaluate(backlog, memoryBytes);
+	return distance != lastDistance;
+}
+
+int RenderDistanceGovernor::getDistance() const
+{
+	return distance;
+}
+
+float RenderDistanceGovernor::getAverageFrameTime() const
+{
+	return averageFrameTime;
+}
+
+// Private
+void RenderDistanceGovernor::evaluate(unsigned int backlog, size_t memoryBytes)
+{
+	if (retryWindows > 0)
+		retryWindows--;
+
+	if (memoryBytes > memoryBudget && distance > minDistance)
+	{
+		setDistance(distance - 1, "memory", backlog, memoryBytes);
+		return;
+	}
+
+	if (averageFrameTime > targetFrameTime * SLOW_FACTOR)
+	{
+		fastWindows = 0;
+		if (++slowWindows < LOWER_WINDOWS || distance == minDistance)
+			return;
+
+		failedDistance = distance;
+		retryWindows = RETRY_WINDOWS;
+		setDistance(distance - 1, "frame time", backlog, memoryBytes);
+		return;
+	}
+
+	if (averageFrameTime < targetFrameTime * FAST_FACTOR && backlog <= MAX_RAISE_BACKLOG && distance < maxDistance)
+	{
+		slowWindows = 0;
+
+		// Loaded chunks grow with the square of the distance
+		float growth = (distance * 2.0f + 3.0f) / (distance * 2.0f + 1.0f);
+		bool fits = memoryBytes * growth * growth <= memoryBudget;
+		bool allowed = distance + 1 != failedDistance || retryWindows == 0;
+		if (!fits || !allowed)
+		{
+			fastWindows = 0;
+			return;
+		}
+
+		if (++fastWindows >= RAISE_WINDOWS)
+			setDistance(distance + 1, "frame time", backlog, memoryBytes);
+		return;
+	}
+
+	slowWindows = 0;
+	fastWindows = 0;
+}
+
+void RenderDistanceGovernor::setDistance(int newDistance, const char* reason, unsigned int backlog, size_t memoryBytes)
+{
+	if (metrics != nullptr)
+	{
+		*metrics << totalTime / 1000.0 << " s render distance " << distance << " -> " << newDistance << " (" << reason << "),"
+			<< " frame " << averageFrameTime << " ms of " << targetFrameTime << " ms,"
+			<< " backlog " << backlog << " chunks,"
+			<< " memory " << memoryBytes / (1024 * 1024) << " of " << memoryBudget / (1024 * 1024) << " MB\n";
+	}
+
+	distance = newDistance;
+	slowWindows = 0;
+	fastWindows = 0;
+}
+
+static bool check(const char* name, bool passed)
+{
+	std::cout << (passed ? "  ok      " : "  FAILED  ") << name << '\n';
+	return passed;
+}
+
+// A machine whose frame time grows with the chunks in view and jitters by up to a tenth. Raising the distance
+// queues the new ring of chunks, which load a few per frame.
+struct SimulatedMachine
+{
+	float baseFrameTime = 4.0f;
+	float chunkFrameTime = 0.04f;
+	size_t chunkBytes = 96 * 1024;
+	int height = 7;
+	// Frames of a frame time spike still to come
+	int spikeFrames = 0;
+	unsigned int backlog = 0;
+	int distance = 0;
+	// Simulated seconds
+	double time = 0.0;
+	std::minstd_rand random{ 1 };
+
+	// Returns how often the distance changed
+	int run(RenderDistanceGovernor& governor, int frames)
+	{
+		std::uniform_real_distribution<float> jitter(0.9f, 1.1f);
+		int changes = 0;
+		for (int frame = 0; frame < frames; frame++)
+		{
+			int side = governor.getDistance() * 2 + 1;
+			if (governor.getDistance() > distance)
+				backlog += side * side * height - (side - 2) * (side - 2) * height;
+			distance = governor.getDistance();
+			backlog -= std::min(backlog, 4u);
+
+			float frameTime = (baseFrameTime + chunkFrameTime * side * side) * jitter(random);
+			if (spikeFrames > 0)
+			{
+				spikeFrames--;
+				frameTime *= 3.0f;
+			}
+			time += frameTime / 1000.0;
+			if (governor.update(frameTime, backlog, getMemory()))
+				changes++;
+		}
+		return changes;
+	}
+
+	size_t getMemory() const
+	{
+		int side = distance * 2 + 3;
+		return side * side * (height + 2) * chunkBytes;
+	}
+};
+
+bool RenderDistanceGovernor::runCheck()
+{
+	bool passed = true;
+
+	std::cout << "Render distance governor checks\n";
+	{
+		// Distance 6 is fast, 7 and 8 are within the hysteresis band and 9 is slow
+		SimulatedMachine machine;
+		RenderDistanceGovernor governor(2, 16, 5);
+		governor.metrics = &std::cout;
+		machine.run(governor, 3600);
+		passed &= check("raises to the largest distance that is fast enough", governor.getDistance() == 7);
+		passed &= check("holds it", machine.run(governor, 3600) == 0);
+	}
+	{
+		SimulatedMachine machine;
+		RenderDistanceGovernor governor(2, 16, 12);
+		governor.metrics = &std::cout;
+		machine.run(governor, 3600);
+		passed &= check("lowers until within the band", governor.getDistance() == 8);
+		passed &= check("holds it", machine.run(governor, 3600) == 0);
+	}
+	{
+		SimulatedMachine machine;
+		RenderDistanceGovernor governor(2, 16, 7);
+		machine.run(governor, 600);
+		machine.spikeFrames = 10;
+		passed &= check("rides out a short spike", machine.run(governor, 600) == 0 && governor.getDistance() == 7);
+	}
+	{
+		// Distance 2 is fast and 3 is slow, so it can only settle by giving up on 3
+		SimulatedMachine machine;
+		machine.baseFrameTime = 0.0f;
+		machine.chunkFrameTime = 0.45f;
+		RenderDistanceGovernor governor(2, 16, 2);
+		int changes = machine.run(governor, 36000);
+		int retries = (int)(machine.time * 1000.0 / (RETRY_WINDOWS * WINDOW_LENGTH));
+		passed &= check("doesn't flip-flop at the edge", changes <= retries * 2 + 2);
+	}
+	{
+		SimulatedMachine machine;
+		machine.baseFrameTime = 1.0f;
+		machine.chunkFrameTime = 0.001f;
+		RenderDistanceGovernor governor(2, 16, 2);
+		governor.setMemoryBudget(13 * 13 * 9 * machine.chunkBytes);
+		machine.run(governor, 7200);
+		passed &= check("raises within the memory budget", governor.getDistance() >= 4 && machine.getMemory() <= 13 * 13 * 9 * machine.chunkBytes);
+
+		governor.setMemoryBudget(9 * 9 * 9 * machine.chunkBytes);
+		machine.run(governor, 600);
+		passed &= check("drops when the budget shrinks", governor.getDistance() == 3 && machine.getMemory() <= 9 * 9 * 9 * machine.chunkBytes);
+	}
+	{
+		SimulatedMachine machine;
+		machine.baseFrameTime = 1.0f;
+		machine.chunkFrameTime = 0.001f;
+		RenderDistanceGovernor governor(2, 16, 4);
+		machine.backlog = 1000000;
+		machine.run(governor, 3600);
+		passed &= check("waits for loading to catch up", governor.getDistance() == 4);
+	}
+
+	return passed;
+}
\ No newline at end of file
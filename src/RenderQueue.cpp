@@ -0,0 +1,111 @@
+#include "headers/RenderQueue.h"
+
+#include <algorithm>
+#include <GL/glew.h>
+
+void RenderQueue::add(RENDER_PASS pass, Shader* shader, unsigned int vertexArray, unsigned int firstIndex, unsigned int indexCount, glm::vec3 offset, float distance)
+{
+	if (indexCount == 0)
+		return;
+
+	items.push_back({ pass, shader, vertexArray, firstIndex, indexCount, 0, offset, distance });
+}
+
+void RenderQueue::addInstanced(RENDER_PASS pass, Shader* shader, unsigned int vertexArray, unsigned int indexCount, unsigned int instanceCount, glm::vec3 offset, float distance)
+{
+	if (instanceCount == 0)
+		return;
+
+	items.push_back({ pass, shader, vertexArray, 0, indexCount, instanceCount, offset, distance });
+}
+
+void RenderQueue::draw()
+{
+	std::sort(items.begin(), items.end(), [](const DrawItem& a, const DrawItem& b)
+	{
+		if (a.pass != b.pass)
+			return a.pass < b.pass;
+		if (a.pass == WATER_PASS && a.distance != b.distance)
+			return a.distance > b.distance;
+		if (a.shader->program != b.shader->program)
+			return a.shader->program < b.shader->program;
+		return a.vertexArray < b.vertexArray;
+	});
+
+	drawCalls = 0;
+	trianglesDrawn = 0;
+	stateChanges = 0;
+
+	int pass = -1;
+	Shader* shader = nullptr;
+	int offsetLocation = -1;
+	for (const DrawItem& item : items)
+	{
+		if (item.pass != pass)
+		{
+			pass = item.pass;
+			beginPass(item.pass);
+			shader = nullptr;
+		}
+
+		if (item.shader != shader)
+		{
+			shader = item.shader;
+			shader->use();
+			offsetLocation = getOffsetLocation(shader->program);
+			stateChanges++;
+		}
+
+		glUniform3f(offsetLocation, item.offset.x, item.offset.y, item.offset.z);
+		glBindVertexArray(item.vertexArray);
+		if (item.instanceCount > 0)
+		{
+			glDrawElementsInstanced(GL_TRIANGLES, item.indexCount, GL_UNSIGNED_INT, (void*)(item.firstIndex * sizeof(unsigned int)), item.instanceCount);
+			trianglesDrawn += item.indexCount / 3 * item.instanceCount;
+		}
+		else
+		{
+			glDrawElements(GL_TRIANGLES, item.indexCount, GL_UNSIGNED_INT, (void*)(item.firstIndex * sizeof(unsigned int)));
+			trianglesDrawn += item.indexCount / 3;
+		}
+		drawCalls++;
+	}
+
+	if (pass != WATER_PASS)
+		glEnable(GL_BLEND);
+	glEnable(GL_CULL_FACE);
+	items.clear();
+}
+
+// Private
+void RenderQueue::beginPass(RENDER_PASS pass)
+{
+	switch (pass)
+	{
+	case SOLID_PASS:
+		glDisable(GL_BLEND);
+		glEnable(GL_CULL_FACE);
+		break;
+	case BILLBOARD_PASS:
+		// Billboards are seen from both sides
+		glDisable(GL_BLEND);
+		glDisable(GL_CULL_FACE);
+		break;
+	case WATER_PASS:
+		glEnable(GL_BLEND);
+		glEnable(GL_CULL_FACE);
+		break;
+	}
+	stateChanges++;
+}
+
+int RenderQueue::getOffsetLocation(unsigned int program)
+{
+	auto it = offsetLocations.find(program);
+	if (it != offsetLocations.end())
+		return it->second;
+
+	int location = glGetUniformLocation(program, "chunkOffset");
+	offsetLocations[program] = location;
+	return location;
+}
\ No newline at end of file
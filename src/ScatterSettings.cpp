@@ -0,0 +1,6 @@
+#include "headers/ScatterSettings.h"
+
+ScatterSettings::ScatterSettings(int _cellSize, int _spacing, float _chance, unsigned int _seed)
+    : cellSize(_cellSize), spacing(_spacing), chance(_chance), seed(_seed){}
+
+ScatterSettings::~ScatterSettings(){}
@@ -0,0 +1,173 @@
+#include "headers/ChunkClient.h"
+
+#include <chrono>
+#include <cstring>
+
+#include "headers/Protocol.h"
+#include "../headers/ChunkCodec.h"
+#include "../headers/Lighting.h"
+#include "../headers/WorldGenCheck.h"
+
+static int32_t readI32(const uint8_t* bytes)
+{
+	return (int32_t)(bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t)bytes[3] << 24));
+}
+
+static uint16_t readU16(const uint8_t* bytes)
+{
+	return bytes[0] | (bytes[1] << 8);
+}
+
+static uint64_t readU64(const uint8_t* bytes)
+{
+	uint64_t value = 0;
+	for (int i = 0; i < 8; i++)
+		value |= (uint64_t)bytes[i] << (i * 8);
+	return value;
+}
+
+ChunkClient::~ChunkClient()
+{
+	for (auto& it : chunkData)
+		delete it.second;
+}
+
+bool ChunkClient::connect(const std::string& host, uint16_t port)
+{
+	connection.reset(Connection::connect(host, port));
+	return connection != nullptr;
+}
+
+void ChunkClient::sendPosition(glm::vec3 position)
+{
+	uint8_t payload[12];
+	memcpy(payload, &position, 12);
+	connection->queueMessage(Protocol::PLAYER_POSITION, payload, 12);
+}
+
+bool ChunkClient::update()
+{
+	if (!connection->flush() || !connection->receive())
+		return false;
+
+	uint8_t type;
+	const uint8_t* payload;
+	uint32_t size;
+	while (connection->nextMessage(type, payload, size))
+	{
+		if (type == Protocol::CHUNK_DATA)
+		{
+			if (!readChunk(payload, size))
+				return false;
+		}
+		else if (type == Protocol::CHUNK_UNLOAD)
+		{
+			unloadChunk(payload, size);
+		}
+		else if (type == Protocol::BLOCK_CHANGES)
+		{
+			applyChanges(payload, size);
+		}
+	}
+	return true;
+}
+
+ChunkData* ChunkClient::getChunkData(ChunkPos chunkPos)
+{
+	auto it = chunkData.find(chunkPos);
+	return it != chunkData.end() ? it->second : nullptr;
+}
+
+unsigned int ChunkClient::getChunkCount() const
+{
+	return chunkData.size();
+}
+
+uint64_t ChunkClient::getBytesReceived() const
+{
+	return connection->bytesReceived;
+}
+
+bool ChunkClient::readChunk(const uint8_t* payload, uint32_t size)
+{
+	if (size < 20)
+		return false;
+
+	auto start = std::chrono::steady_clock::now();
+
+	ChunkPos chunkPos(readI32(payload), readI32(payload + 4), readI32(payload + 8));
+	uint64_t fingerprint = readU64(payload + 12);
+
+	// A resent chunk is decoded over the old blocks, a new one into a fresh array
+	ChunkData* data = getChunkData(chunkPos);
+	bool isNew = data == nullptr;
+	uint16_t* blocks = isNew ? new uint16_t[CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE] : data->data;
+	if (ChunkCodec::decode(payload + 20, size - 20, blocks) == 0)
+	{
+		if (isNew)
+			delete[] blocks;
+		return false;
+	}
+	if (isNew)
+	{
+		data = new ChunkData(blocks);
+		chunkData[chunkPos] = data;
+	}
+	else
+	{
+		data->countTickable();
+	}
+
+	if (WorldGenCheck::fingerprint(blocks) != fingerprint)
+		fingerprintMismatches++;
+	chunksReceived++;
+
+	decodeMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	// Light isn't sent, it is worked out from the blocks with the sky entering through the chunk above
+	Lighting::relightChunk(data, getChunkData({ chunkPos.x, chunkPos.y + 1, chunkPos.z }));
+	return true;
+}
+
+void ChunkClient::unloadChunk(const uint8_t* payload, uint32_t size)
+{
+	if (size < 12)
+		return;
+
+	ChunkPos chunkPos(readI32(payload), readI32(payload + 4), readI32(payload + 8));
+	auto it = chunkData.find(chunkPos);
+	if (it != chunkData.end())
+	{
+		delete it->second;
+		chunkData.erase(it);
+	}
+}
+
+void ChunkClient::applyChanges(const uint8_t* payload, uint32_t size)
+{
+	if (size < 14)
+		return;
+
+	ChunkPos chunkPos(readI32(payload), readI32(payload + 4), readI32(payload + 8));
+	uint16_t count = readU16(payload + 12);
+	ChunkData* data = getChunkData(chunkPos);
+	if (data == nullptr || size < 14 + count * 4u)
+		return;
+
+	// Nothing here is drawn, so the chunks the light spread into need no more work
+	std::vector<ChunkPos> relitChunks;
+	for (uint16_t i = 0; i < count; i++)
+	{
+		uint16_t index = readU16(payload + 14 + i * 4);
+		uint16_t block = readU16(payload + 16 + i * 4);
+		if (index >= CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE)
+			continue;
+
+		int x = index / (CHUNK_SIZE * CHUNK_SIZE);
+		int y = index % CHUNK_SIZE;
+		int z = index / CHUNK_SIZE % CHUNK_SIZE;
+		data->setBlock(x, y, z, block);
+		Lighting::updateBlock(chunkPos, [this](ChunkPos lightPos) { return getChunkData(lightPos); }, x, y, z, relitChunks);
+	}
+	blockChangesReceived += count;
+}
\ No newline at end of file
@@ -0,0 +1,302 @@
+#include "headers/ChunkServer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "headers/Protocol.h"
+#include "../headers/ChunkCodec.h"
+#include "../headers/WorldGenCheck.h"
+
+// More unsent bytes than this and a client gets nothing new until its socket drains
+constexpr size_t MAX_PENDING_BYTES = 256 * 1024;
+
+static void writeU16(std::vector<uint8_t>& out, uint16_t value)
+{
+	out.push_back(value);
+	out.push_back(value >> 8);
+}
+
+static void writeI32(std::vector<uint8_t>& out, int32_t value)
+{
+	for (int i = 0; i < 4; i++)
+		out.push_back((uint32_t)value >> (i * 8));
+}
+
+static void writeU64(std::vector<uint8_t>& out, uint64_t value)
+{
+	for (int i = 0; i < 8; i++)
+		out.push_back(value >> (i * 8));
+}
+
+static ChunkPos getChunkPos(glm::vec3 position)
+{
+	return ChunkPos(
+		(int)floorf(position.x / CHUNK_SIZE),
+		(int)floorf(position.y / CHUNK_SIZE),
+		(int)floorf(position.z / CHUNK_SIZE));
+}
+
+ChunkServer::ChunkServer(World& world, unsigned int bytesPerSecond)
+	: world(world), bytesPerSecond(bytesPerSecond)
+{
+
+}
+
+bool ChunkServer::listen(uint16_t port, bool anyInterface)
+{
+	return listener.listen(port, anyInterface);
+}
+
+void ChunkServer::update()
+{
+	while (Connection* connection = listener.accept())
+	{
+		clients.emplace_back(new Client());
+		clients.back()->connection.reset(connection);
+	}
+
+	for (auto it = clients.begin(); it != clients.end(); )
+	{
+		if (!(*it)->connection->receive() || !receiveMessages(**it))
+		{
+			disconnect(**it);
+			it = clients.erase(it);
+			continue;
+		}
+		++it;
+	}
+
+	broadcastChanges();
+
+	double tickBudget = bytesPerSecond * TICK_LENGTH / 1000.0;
+	for (auto it = clients.begin(); it != clients.end(); )
+	{
+		Client& client = **it;
+
+		// Unused budget carries over for one tick at most, so an idle client can't save up a burst
+		client.budget = std::min(client.budget + tickBudget, tickBudget * 2);
+		if (client.hasPosition)
+			sendChunks(client);
+
+		if (!client.connection->flush())
+		{
+			disconnect(client);
+			it = clients.erase(it);
+			continue;
+		}
+		++it;
+	}
+}
+
+std::vector<glm::vec3> ChunkServer::getClientPositions() const
+{
+	std::vector<glm::vec3> positions;
+	for (auto& client : clients)
+	{
+		if (client->hasPosition)
+			positions.push_back(client->position);
+	}
+	return positions;
+}
+
+unsigned int ChunkServer::getClientCount() const
+{
+	return clients.size();
+}
+
+bool ChunkServer::receiveMessages(Client& client)
+{
+	uint8_t type;
+	const uint8_t* payload;
+	uint32_t size;
+	while (client.connection->nextMessage(type, payload, size))
+	{
+		if (type == Protocol::PLAYER_POSITION && size == 12)
+		{
+			float coordinates[3];
+			memcpy(coordinates, payload, 12);
+			for (float coordinate : coordinates)
+			{
+				if (!std::isfinite(coordinate) || fabsf(coordinate) > Protocol::MAX_POSITION)
+					return false;
+			}
+
+			client.position = glm::vec3(coordinates[0], coordinates[1], coordinates[2]);
+			client.hasPosition = true;
+		}
+	}
+	return true;
+}
+
+void ChunkServer::disconnect(Client& client)
+{
+	for (const ChunkPos& chunkPos : std::vector<ChunkPos>(client.sentChunks.begin(), client.sentChunks.end()))
+		unsubscribe(client, chunkPos);
+}
+
+void ChunkServer::broadcastChanges()
+{
+	if (world.blockChanges.empty())
+		return;
+
+	// Group the tick's changes by chunk, keeping only the last change to each block
+	std::unordered_map<ChunkPos, std::unordered_map<uint16_t, uint16_t>, ChunkPosHash> chunkChanges;
+	for (const BlockChange& change : world.blockChanges)
+	{
+		if (subscribers.find(change.chunkPos) != subscribers.end())
+			chunkChanges[change.chunkPos][change.index] = change.block;
+	}
+
+	std::vector<uint8_t> payload;
+	for (auto& it : chunkChanges)
+	{
+		std::vector<Client*>& chunkSubscribers = subscribers[it.first];
+
+		// Cheaper to send the whole chunk again, which happens as soon as the subscribers scan for it
+		if (it.second.size() > Protocol::MAX_BLOCK_CHANGES)
+		{
+			for (Client* client : std::vector<Client*>(chunkSubscribers))
+			{
+				unsubscribe(*client, it.first);
+				client->needsScan = true;
+			}
+			continue;
+		}
+
+		payload.clear();
+		writeI32(payload, it.first.x);
+		writeI32(payload, it.first.y);
+		writeI32(payload, it.first.z);
+		writeU16(payload, it.second.size());
+		for (auto& change : it.second)
+		{
+			writeU16(payload, change.first);
+			writeU16(payload, change.second);
+		}
+
+		for (Client* client : chunkSubscribers)
+		{
+			client->connection->queueMessage(Protocol::BLOCK_CHANGES, payload.data(), payload.size());
+			client->budget -= payload.size();
+			changeMessagesSent++;
+		}
+	}
+}
+
+void ChunkServer::sendChunks(Client& client)
+{
+	ChunkPos center = getChunkPos(client.position);
+
+	// Forget chunks the client walked away from
+	if (!(center == client.center))
+	{
+		client.center = center;
+		client.needsScan = true;
+
+		std::vector<ChunkPos> outOfRange;
+		for (const ChunkPos& chunkPos : client.sentChunks)
+		{
+			if (abs(chunkPos.x - center.x) > world.renderDistance ||
+				abs(chunkPos.y - center.y) > world.renderHeight ||
+				abs(chunkPos.z - center.z) > world.renderDistance)
+				outOfRange.push_back(chunkPos);
+		}
+
+		for (const ChunkPos& chunkPos : outOfRange)
+		{
+			sendUnload(client, chunkPos);
+			unsubscribe(client, chunkPos);
+		}
+	}
+
+	// A client that has everything around it costs nothing until it moves or a chunk is resent
+	if (!client.needsScan)
+		return;
+	client.needsScan = false;
+
+	// Nearest unsent chunks first
+	std::vector<std::pair<int, ChunkPos>> candidates;
+	for (int x = -world.renderDistance; x <= world.renderDistance; x++)
+	{
+		for (int z = -world.renderDistance; z <= world.renderDistance; z++)
+		{
+			for (int y = -world.renderHeight; y <= world.renderHeight; y++)
+			{
+				ChunkPos chunkPos(center.x + x, center.y + y, center.z + z);
+				if (client.sentChunks.find(chunkPos) == client.sentChunks.end())
+					candidates.emplace_back(x * x + y * y + z * z, chunkPos);
+			}
+		}
+	}
+
+	std::sort(candidates.begin(), candidates.end(), [](const std::pair<int, ChunkPos>& a, const std::pair<int, ChunkPos>& b)
+	{
+		return a.first < b.first;
+	});
+
+	for (auto& candidate : candidates)
+	{
+		// Stop while the socket is still backed up, so chunks that go stale in the buffer aren't piling up
+		if (client.budget <= 0.0 || client.connection->getPendingBytes() > MAX_PENDING_BYTES)
+		{
+			client.needsScan = true;
+			break;
+		}
+
+		ChunkData* data = world.getChunkData(candidate.second);
+		if (data != nullptr)
+			sendChunk(client, candidate.second, data);
+		else
+			client.needsScan = true;
+	}
+}
+
+void ChunkServer::sendChunk(Client& client, ChunkPos chunkPos, ChunkData* data)
+{
+	Connection& connection = *client.connection;
+
+	// Encode straight into the send buffer
+	size_t messageStart = connection.beginMessage(Protocol::CHUNK_DATA);
+	std::vector<uint8_t>& out = connection.getSendBuffer();
+	writeI32(out, chunkPos.x);
+	writeI32(out, chunkPos.y);
+	writeI32(out, chunkPos.z);
+	writeU64(out, WorldGenCheck::fingerprint(data->data));
+	ChunkCodec::encode(data->data, out);
+	connection.finishMessage(messageStart);
+
+	client.budget -= out.size() - messageStart;
+	subscribe(client, chunkPos);
+	chunksSent++;
+}
+
+void ChunkServer::sendUnload(Client& client, ChunkPos chunkPos)
+{
+	Connection& connection = *client.connection;
+
+	size_t messageStart = connection.beginMessage(Protocol::CHUNK_UNLOAD);
+	std::vector<uint8_t>& out = connection.getSendBuffer();
+	writeI32(out, chunkPos.x);
+	writeI32(out, chunkPos.y);
+	writeI32(out, chunkPos.z);
+	connection.finishMessage(messageStart);
+}
+
+void ChunkServer::subscribe(Client& client, ChunkPos chunkPos)
+{
+	if (client.sentChunks.insert(chunkPos).second)
+		subscribers[chunkPos].push_back(&client);
+}
+
+void ChunkServer::unsubscribe(Client& client, ChunkPos chunkPos)
+{
+	if (client.sentChunks.erase(chunkPos) == 0)
+		return;
+
+	auto it = subscribers.find(chunkPos);
+	std::vector<Client*>& chunkSubscribers = it->second;
+	chunkSubscribers.erase(std::find(chunkSubscribers.begin(), chunkSubscribers.end(), &client));
+	if (chunkSubscribers.empty())
+		subscribers.erase(it);
+}
\ No newline at end of file
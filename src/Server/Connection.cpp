@@ -0,0 +1,217 @@
+#include "headers/Connection.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "headers/Protocol.h"
+
+static const size_t HEADER_SIZE = 5;
+
+static void setNonBlocking(int socket)
+{
+	fcntl(socket, F_SETFL, fcntl(socket, F_GETFL, 0) | O_NONBLOCK);
+
+	// Chunks go out in bursts, don't hold small messages back
+	int noDelay = 1;
+	setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+}
+
+static void writeU32(uint8_t* bytes, uint32_t value)
+{
+	bytes[0] = value & 0xFF;
+	bytes[1] = (value >> 8) & 0xFF;
+	bytes[2] = (value >> 16) & 0xFF;
+	bytes[3] = value >> 24;
+}
+
+// Connection
+Connection::Connection(int socket)
+	: socket(socket)
+{
+	setNonBlocking(socket);
+}
+
+Connection::~Connection()
+{
+	close(socket);
+}
+
+Connection* Connection::connect(const std::string& host, uint16_t port)
+{
+	addrinfo hints{};
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_STREAM;
+
+	addrinfo* addresses;
+	if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses) != 0)
+		return nullptr;
+
+	int socket = ::socket(AF_INET, SOCK_STREAM, 0);
+	int result = socket >= 0 ? ::connect(socket, addresses->ai_addr, addresses->ai_addrlen) : -1;
+	freeaddrinfo(addresses);
+
+	if (result != 0)
+	{
+		if (socket >= 0)
+			close(socket);
+		return nullptr;
+	}
+
+	return new Connection(socket);
+}
+
+void Connection::queueMessage(uint8_t type, const uint8_t* payload, size_t size)
+{
+	size_t messageStart = beginMessage(type);
+	sendBuffer.insert(sendBuffer.end(), payload, payload + size);
+	finishMessage(messageStart);
+}
+
+size_t Connection::beginMessage(uint8_t type)
+{
+	size_t messageStart = sendBuffer.size();
+	sendBuffer.resize(messageStart + HEADER_SIZE);
+	sendBuffer[messageStart + 4] = type;
+	return messageStart;
+}
+
+void Connection::finishMessage(size_t messageStart)
+{
+	writeU32(sendBuffer.data() + messageStart, sendBuffer.size() - messageStart - HEADER_SIZE);
+}
+
+std::vector<uint8_t>& Connection::getSendBuffer()
+{
+	return sendBuffer;
+}
+
+bool Connection::flush()
+{
+	while (open && sendOffset < sendBuffer.size())
+	{
+		ssize_t sent = send(socket, sendBuffer.data() + sendOffset, sendBuffer.size() - sendOffset, MSG_NOSIGNAL);
+		if (sent < 0)
+		{
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				break;
+			open = false;
+			break;
+		}
+
+		sendOffset += sent;
+		bytesSent += sent;
+	}
+
+	// Drop the sent front once it's worth the move
+	if (sendOffset == sendBuffer.size())
+	{
+		sendBuffer.clear();
+		sendOffset = 0;
+	}
+	else if (sendOffset > 1 << 16)
+	{
+		sendBuffer.erase(sendBuffer.begin(), sendBuffer.begin() + sendOffset);
+		sendOffset = 0;
+	}
+
+	return open;
+}
+
+bool Connection::receive()
+{
+	// Messages handed out by nextMessage are done with now
+	receiveBuffer.erase(receiveBuffer.begin(), receiveBuffer.begin() + receiveOffset);
+	receiveOffset = 0;
+
+	uint8_t buffer[1 << 16];
+	while (open)
+	{
+		ssize_t received = recv(socket, buffer, sizeof(buffer), 0);
+		if (received < 0)
+		{
+			if (errno != EAGAIN && errno != EWOULDBLOCK)
+				open = false;
+			break;
+		}
+		if (received == 0)
+		{
+			open = false;
+			break;
+		}
+
+		receiveBuffer.insert(receiveBuffer.end(), buffer, buffer + received);
+		bytesReceived += received;
+	}
+
+	return open;
+}
+
+bool Connection::nextMessage(uint8_t& type, const uint8_t*& payload, uint32_t& size)
+{
+	if (receiveBuffer.size() - receiveOffset < HEADER_SIZE)
+		return false;
+
+	const uint8_t* header = receiveBuffer.data() + receiveOffset;
+	size = header[0] | (header[1] << 8) | (header[2] << 16) | ((uint32_t)header[3] << 24);
+	if (size > Protocol::MAX_MESSAGE_SIZE)
+	{
+		open = false;
+		return false;
+	}
+	if (receiveBuffer.size() - receiveOffset - HEADER_SIZE < size)
+		return false;
+
+	type = header[4];
+	payload = header + HEADER_SIZE;
+	receiveOffset += HEADER_SIZE + size;
+	return true;
+}
+
+size_t Connection::getPendingBytes() const
+{
+	return sendBuffer.size() - sendOffset;
+}
+
+// Listener
+Listener::Listener()
+{
+
+}
+
+Listener::~Listener()
+{
+	if (socket >= 0)
+		close(socket);
+}
+
+bool Listener::listen(uint16_t port, bool anyInterface)
+{
+	socket = ::socket(AF_INET, SOCK_STREAM, 0);
+	if (socket < 0)
+		return false;
+
+	int reuse = 1;
+	setsockopt(socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+	sockaddr_in address{};
+	address.sin_family = AF_INET;
+	address.sin_port = htons(port);
+	address.sin_addr.s_addr = htonl(anyInterface ? INADDR_ANY : INADDR_LOOPBACK);
+	if (bind(socket, (sockaddr*)&address, sizeof(address)) != 0 || ::listen(socket, 16) != 0)
+		return false;
+
+	fcntl(socket, F_SETFL, fcntl(socket, F_GETFL, 0) | O_NONBLOCK);
+	return true;
+}
+
+Connection* Listener::accept()
+{
+	int client = ::accept(socket, nullptr, nullptr);
+	return client >= 0 ? new Connection(client) : nullptr;
+}
\ No newline at end of file
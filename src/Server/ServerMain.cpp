@@ -0,0 +1,280 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "../headers/World.h"
+#include "../headers/WorldGen.h"
+#include "../headers/WorldGenCheck.h"
+#include "../headers/Blocks.h"
+#include "../headers/JobSystem.h"
+#include "../headers/OcclusionCuller.h"
+#include "../headers/HorizonCuller.h"
+#include "../headers/RenderDistanceGovernor.h"
+#include "../headers/WorldEdit.h"
+#include "headers/ChunkServer.h"
+#include "headers/ChunkClient.h"
+#include "headers/Protocol.h"
+
+// Headless server: simulates the world around a number of scripted players, no window, SDL or OpenGL needed.
+//
+// --players N     simulated players walking circles around the origin (default 4)
+// --ticks N       stop after N ticks, 0 runs until killed (default 0)
+// --save DIR      directory edited chunks are saved to (default "world")
+// --fast          run ticks back to back instead of every TICK_LENGTH
+// --listen PORT   stream chunks to thin clients on the port (default Protocol::DEFAULT_PORT, 0 disables)
+// --public        accept clients on every interface instead of loopback only
+// --bandwidth KB  bytes per second each client may be sent, in kilobytes (default 1024)
+// --connect PORT  run a scripted thin client against a server on this machine instead of a server
+// --loopback-test run a server and a scripted client in one process, exit with 1 if any chunk arrived wrong
+// --check-worldgen [threads]   compare generated chunks with the golden fingerprints and exit
+// --bench-jobs [threads]       time the job system with up to this many workers (default 64) and exit
+// --bench-occlusion            check and time the software occlusion culling and exit, with 1 if a check failed
+// --bench-horizon              check and time the horizon culling and exit, with 1 if a check failed
+// --check-governor             check the render distance governor against a simulated machine and exit, with 1 if a check failed
+// --bench-worldedit [size]     time bulk edits of a size^3 box (default 256) and exit
+
+// Walks a thin client in a straight line and reports what it received
+static int runClient(uint16_t port, uint64_t maxTicks)
+{
+	ChunkClient client;
+	if (!client.connect("127.0.0.1", port))
+	{
+		std::cout << "Could not connect to port " << port << '\n';
+		return 1;
+	}
+
+	auto nextTick = std::chrono::steady_clock::now();
+	for (uint64_t tick = 1; maxTicks == 0 || tick <= maxTicks; tick++)
+	{
+		float x = tick * 0.2f;
+		client.sendPosition(glm::vec3(x, WorldGen::surfaceHeight((int)x, 0) + 2.0f, 0.0f));
+		if (!client.update())
+		{
+			std::cout << "Disconnected\n";
+			break;
+		}
+
+		if (tick % 100 == 0)
+		{
+			std::cout << "Tick " << tick
+				<< " Chunks: " << client.getChunkCount()
+				<< " Received: " << client.getBytesReceived() / 1024 << " KB"
+				<< " Avg Decode: " << client.decodeMilliseconds / std::max<uint64_t>(client.chunksReceived, 1) << " ms"
+				<< " Mismatches: " << client.fingerprintMismatches << '\n';
+		}
+
+		nextTick += std::chrono::microseconds((int)(TICK_LENGTH * 1000));
+		std::this_thread::sleep_until(nextTick);
+	}
+
+	return client.fingerprintMismatches == 0 ? 0 : 1;
+}
+
+// Streams to a client in the same process over loopback and checks every chunk it holds against the world
+static int runLoopbackTest(const std::string& saveDirectory, unsigned int bandwidth)
+{
+	World world(saveDirectory);
+	ChunkServer server(world, bandwidth);
+	uint16_t port = Protocol::DEFAULT_PORT + 1;
+	if (!server.listen(port, false))
+	{
+		std::cout << "Could not listen on port " << port << '\n';
+		return 1;
+	}
+
+	ChunkClient client;
+	if (!client.connect("127.0.0.1", port))
+	{
+		std::cout << "Could not connect to port " << port << '\n';
+		return 1;
+	}
+
+	glm::vec3 position(0.0f, WorldGen::surfaceHeight(0, 0) + 2.0f, 0.0f);
+	for (int tick = 0; tick < 400; tick++)
+	{
+		client.sendPosition(position);
+		client.update();
+
+		world.setInterestCenters(server.getClientPositions());
+		// Dig now and then so edited chunks are resent
+		if (tick % 20 == 0)
+			world.editBlock(tick / 20, (int)position.y - 2 - tick / 100, 0, Blocks::AIR);
+		world.tick();
+		server.update();
+		world.blockChanges.clear();
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+
+	// Let the last messages arrive
+	for (int i = 0; i < 20; i++)
+	{
+		server.update();
+		client.update();
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+
+	int compared = 0;
+	int different = 0;
+	int chunkCount = world.renderDistance;
+	for (int x = -chunkCount; x <= chunkCount; x++)
+	{
+		for (int z = -chunkCount; z <= chunkCount; z++)
+		{
+			for (int y = -world.renderHeight; y <= world.renderHeight; y++)
+			{
+				ChunkPos chunkPos(x, y + (int)floorf(position.y / CHUNK_SIZE), z);
+				ChunkData* sent = world.getChunkData(chunkPos);
+				ChunkData* received = client.getChunkData(chunkPos);
+				if (sent == nullptr || received == nullptr)
+					continue;
+
+				compared++;
+				if (memcmp(sent->data, received->data, CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE * sizeof(uint16_t)) != 0 ||
+					memcmp(sent->tickableCounts, received->tickableCounts, sizeof(sent->tickableCounts)) != 0)
+					different++;
+			}
+		}
+	}
+
+	uint64_t rawBytes = client.chunksReceived * CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE * sizeof(uint16_t);
+	std::cout << "Received " << client.chunksReceived << " chunks in " << client.getBytesReceived() / 1024 << " KB ("
+		<< rawBytes / 1024 << " KB raw), avg decode " << client.decodeMilliseconds / std::max<uint64_t>(client.chunksReceived, 1) << " ms\n"
+		<< client.blockChangesReceived << " block changes received\n"
+		<< "Compared " << compared << " chunks, " << different << " different, "
+		<< client.fingerprintMismatches << " fingerprint mismatches\n";
+
+	return compared > 0 && different == 0 && client.fingerprintMismatches == 0 ? 0 : 1;
+}
+
+int main(int argc, char** argv)
+{
+	int playerCount = 4;
+	uint64_t maxTicks = 0;
+	std::string saveDirectory = "world";
+	bool fast = false;
+	int listenPort = Protocol::DEFAULT_PORT;
+	bool anyInterface = false;
+	unsigned int bandwidth = 1024 * 1024;
+	int connectPort = 0;
+	bool loopbackTest = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--players") == 0 && i + 1 < argc)
+			playerCount = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc)
+			maxTicks = strtoull(argv[++i], nullptr, 10);
+		else if (strcmp(argv[i], "--save") == 0 && i + 1 < argc)
+			saveDirectory = argv[++i];
+		else if (strcmp(argv[i], "--fast") == 0)
+			fast = true;
+		else if (strcmp(argv[i], "--listen") == 0 && i + 1 < argc)
+			listenPort = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--public") == 0)
+			anyInterface = true;
+		else if (strcmp(argv[i], "--bandwidth") == 0 && i + 1 < argc)
+			bandwidth = atoi(argv[++i]) * 1024;
+		else if (strcmp(argv[i], "--connect") == 0 && i + 1 < argc)
+			connectPort = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--loopback-test") == 0)
+			loopbackTest = true;
+		else if (strcmp(argv[i], "--check-worldgen") == 0)
+			return WorldGenCheck::run(i + 1 < argc ? atoi(argv[i + 1]) : 4) ? 0 : 1;
+		else if (strcmp(argv[i], "--bench-jobs") == 0)
+		{
+			JobSystem::runBenchmark(i + 1 < argc ? atoi(argv[i + 1]) : 64);
+			return 0;
+		}
+		else if (strcmp(argv[i], "--bench-occlusion") == 0)
+			return OcclusionCuller::runBenchmark() ? 0 : 1;
+		else if (strcmp(argv[i], "--bench-horizon") == 0)
+			return HorizonCuller::runBenchmark() ? 0 : 1;
+		else if (strcmp(argv[i], "--bench-worldedit") == 0)
+		{
+			WorldEdit::runBenchmark(i + 1 < argc ? atoi(argv[i + 1]) : 256);
+			return 0;
+		}
+		else if (strcmp(argv[i], "--check-governor") == 0)
+			return RenderDistanceGovernor::runCheck() ? 0 : 1;
+	}
+
+	if (connectPort != 0)
+		return runClient(connectPort, maxTicks);
+	if (loopbackTest)
+		return runLoopbackTest(saveDirectory, bandwidth);
+
+	World world(saveDirectory);
+	ChunkServer server(world, bandwidth);
+	if (listenPort != 0)
+	{
+		if (server.listen(listenPort, anyInterface))
+			std::cout << "Listening on port " << listenPort << '\n';
+		else
+			std::cout << "Could not listen on port " << listenPort << '\n';
+	}
+
+	std::cout << "Server running with " << playerCount << " players, saving to " << saveDirectory << '\n';
+
+	std::vector<glm::vec3> players(playerCount);
+	auto nextTick = std::chrono::steady_clock::now();
+	double tickMilliseconds = 0.0;
+
+	while (maxTicks == 0 || world.tickCount < maxTicks)
+	{
+		auto start = std::chrono::steady_clock::now();
+
+		// Each player walks its own circle at about 4 blocks per second
+		for (int i = 0; i < playerCount; i++)
+		{
+			float radius = 48.0f * (i + 1);
+			float angle = world.tickCount * 0.2f / radius + i * 2.0f;
+			float x = cosf(angle) * radius;
+			float z = sinf(angle) * radius;
+			players[i] = glm::vec3(x, WorldGen::surfaceHeight((int)x, (int)z) + 2.0f, z);
+		}
+		std::vector<glm::vec3> centers = players;
+		std::vector<glm::vec3> clientPositions = server.getClientPositions();
+		centers.insert(centers.end(), clientPositions.begin(), clientPositions.end());
+		world.setInterestCenters(centers);
+
+		// Every second each player digs out the block it stands on
+		if (world.tickCount % 20 == 0)
+		{
+			for (const glm::vec3& player : players)
+				world.editBlock((int)floorf(player.x), (int)player.y - 2, (int)floorf(player.z), Blocks::AIR);
+		}
+
+		world.tick();
+		server.update();
+		world.blockChanges.clear();
+
+		tickMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		if (world.tickCount % 100 == 0)
+		{
+			std::cout << "Tick " << world.tickCount
+				<< " Loaded Chunks: " << world.getLoadedChunkCount()
+				<< " Queued Chunks: " << world.getQueuedChunkCount()
+				<< " Water Cells: " << world.fluidSimulation.lastTickCells
+				<< " Clients: " << server.getClientCount()
+				<< " Chunks Sent: " << server.chunksSent
+				<< " Change Messages: " << server.changeMessagesSent
+				<< " Avg Tick: " << tickMilliseconds / 100 << " ms\n";
+			tickMilliseconds = 0.0;
+		}
+
+		if (!fast)
+		{
+			nextTick += std::chrono::microseconds((int)(TICK_LENGTH * 1000));
+			std::this_thread::sleep_until(nextTick);
+		}
+	}
+
+	world.save();
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <glm/glm.hpp>
+
+#include "Connection.h"
+#include "../../Chunk/headers/ChunkData.h"
+#include "../../Chunk/headers/ChunkPosHash.h"
+
+// A thin client that keeps whatever chunks the server streams to it, without generating any itself
+class ChunkClient
+{
+public:
+	~ChunkClient();
+
+	bool connect(const std::string& host, uint16_t port);
+
+	void sendPosition(glm::vec3 position);
+	// Sends queued messages and decodes every chunk that arrived, false once the connection dropped
+	bool update();
+
+	ChunkData* getChunkData(ChunkPos chunkPos);
+	unsigned int getChunkCount() const;
+	uint64_t getBytesReceived() const;
+
+private:
+	bool readChunk(const uint8_t* payload, uint32_t size);
+	void unloadChunk(const uint8_t* payload, uint32_t size);
+	void applyChanges(const uint8_t* payload, uint32_t size);
+
+public:
+	uint64_t chunksReceived = 0;
+	uint64_t blockChangesReceived = 0;
+	// Chunks whose decoded blocks didn't match the fingerprint the server sent
+	uint64_t fingerprintMismatches = 0;
+	double decodeMilliseconds = 0.0;
+
+private:
+	std::unique_ptr<Connection> connection;
+	std::unordered_map<ChunkPos, ChunkData*, ChunkPosHash> chunkData;
+};
\ No newline at end of file
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <glm/glm.hpp>
+
+#include "Connection.h"
+#include "../../headers/World.h"
+
+// Streams the world's chunks to connected clients, nearest to each client first,
+// never sending a client more than its share of bytesPerSecond.
+// After a client has a chunk it is subscribed to it and only gets that chunk's block changes, batched per tick.
+class ChunkServer
+{
+public:
+	ChunkServer(World& world, unsigned int bytesPerSecond);
+
+	bool listen(uint16_t port, bool anyInterface);
+
+	// Accepts clients, reads their positions, sends the tick's block changes (World::blockChanges) to
+	// subscribers and new chunks within each client's budget, once per tick
+	void update();
+
+	std::vector<glm::vec3> getClientPositions() const;
+	unsigned int getClientCount() const;
+
+private:
+	struct Client
+	{
+		std::unique_ptr<Connection> connection;
+		glm::vec3 position;
+		bool hasPosition = false;
+		ChunkPos center;
+		// Chunks around the center may still be unsent, cleared once a scan finds nothing left to send
+		bool needsScan = true;
+		std::unordered_set<ChunkPos, ChunkPosHash> sentChunks;
+		// Bytes the client may still be sent, refilled every tick
+		double budget = 0.0;
+	};
+
+	// False if the client sent something it never could have, it is dropped then
+	bool receiveMessages(Client& client);
+	// Drops the client's subscriptions before it is removed
+	void disconnect(Client& client);
+	void broadcastChanges();
+	void sendChunks(Client& client);
+	void sendChunk(Client& client, ChunkPos chunkPos, ChunkData* data);
+	void sendUnload(Client& client, ChunkPos chunkPos);
+
+	void subscribe(Client& client, ChunkPos chunkPos);
+	void unsubscribe(Client& client, ChunkPos chunkPos);
+
+public:
+	uint64_t chunksSent = 0;
+	uint64_t changeMessagesSent = 0;
+
+private:
+	World& world;
+	Listener listener;
+	std::vector<std::unique_ptr<Client>> clients;
+	// Interest grid: the clients holding each chunk
+	std::unordered_map<ChunkPos, std::vector<Client*>, ChunkPosHash> subscribers;
+	unsigned int bytesPerSecond;
+};
\ No newline at end of file
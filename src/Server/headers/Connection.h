@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A non-blocking TCP connection carrying Protocol framed messages (POSIX sockets)
+class Connection
+{
+public:
+	Connection(int socket);
+	~Connection();
+
+	Connection(const Connection&) = delete;
+	Connection& operator=(const Connection&) = delete;
+
+	// Connects to a server, returns null on failure
+	static Connection* connect(const std::string& host, uint16_t port);
+
+	// Frames a message into the send buffer, call flush to send it
+	void queueMessage(uint8_t type, const uint8_t* payload, size_t size);
+	// Starts a message whose payload the caller appends straight to getSendBuffer(), then closes with finishMessage
+	size_t beginMessage(uint8_t type);
+	void finishMessage(size_t messageStart);
+	std::vector<uint8_t>& getSendBuffer();
+
+	// Sends as much of the send buffer as the socket takes, false if the connection dropped
+	bool flush();
+	// Reads whatever has arrived, false if the connection dropped
+	bool receive();
+	// Returns the next complete message; payload points into the receive buffer and stays valid until receive is called
+	bool nextMessage(uint8_t& type, const uint8_t*& payload, uint32_t& size);
+
+	size_t getPendingBytes() const;
+
+public:
+	uint64_t bytesSent = 0;
+	uint64_t bytesReceived = 0;
+
+private:
+	int socket;
+	bool open = true;
+	std::vector<uint8_t> sendBuffer;
+	size_t sendOffset = 0;
+	std::vector<uint8_t> receiveBuffer;
+	size_t receiveOffset = 0;
+};
+
+// Accepts connections on a port without blocking
+class Listener
+{
+public:
+	Listener();
+	~Listener();
+
+	// Listens on the port, on the loopback interface only unless anyInterface is set
+	bool listen(uint16_t port, bool anyInterface);
+	// Returns the next waiting connection or null
+	Connection* accept();
+
+private:
+	int socket = -1;
+};
\ No newline at end of file
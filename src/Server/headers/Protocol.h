@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+// Messages between the server and thin clients. Every message is framed as
+// payload length (u32), message type (u8), payload. Little endian.
+namespace Protocol
+{
+	enum MESSAGE_TYPE : uint8_t
+	{
+		// Server to client: chunk x, y, z (i32 each), block fingerprint (u64), ChunkCodec data
+		CHUNK_DATA = 1,
+		// Server to client: chunk x, y, z (i32 each) the client should forget
+		CHUNK_UNLOAD = 2,
+		// Client to server: player position x, y, z (f32 each)
+		PLAYER_POSITION = 3,
+		// Server to client: chunk x, y, z (i32 each), change count (u16), then per change the
+		// block's index into the chunk data (u16) and its new id (u16). One per edited chunk per tick.
+		BLOCK_CHANGES = 4
+	};
+
+	constexpr uint16_t DEFAULT_PORT = 25565;
+	// A chunk with more changes in one tick is sent whole instead, which is about as small by then
+	constexpr uint16_t MAX_BLOCK_CHANGES = 1024;
+	// Largest payload either side accepts
+	constexpr uint32_t MAX_MESSAGE_SIZE = 1 << 20;
+	// Farthest a player position may be from the origin on any axis, clients sending more are dropped
+	constexpr float MAX_POSITION = 1.0e7f;
+}
\ No newline at end of file
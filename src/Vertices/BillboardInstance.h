@@ -0,0 +1,10 @@
+#pragma once
+
+// One plant in a chunk, drawn as an instance of the shared crossed quad pair in its block cell
+struct BillboardInstance {
+    char posX, posY, posZ;
+    char texGridX, texGridY;
+
+    BillboardInstance(char _posX, char _posY, char _posZ, char _texGridX, char _texGridY)
+        : posX(_posX), posY(_posY), posZ(_posZ), texGridX(_texGridX), texGridY(_texGridY) {}
+};
\ No newline at end of file
@@ -3,7 +3,9 @@
 #include "_Vertex.h"
 
 struct WorldVertex : public Vertex {
+    // Light level of the voxel the face looks into, 0-15
+    char light;
 
-    WorldVertex(char _posX, char _posY, char _posZ, char _texGridX, char _texGridY, char _direction)
-        : Vertex(_posX, _posY, _posZ, _texGridX, _texGridY, _direction) {}
+    WorldVertex(char _posX, char _posY, char _posZ, char _texGridX, char _texGridY, char _direction, char _light)
+        : Vertex(_posX, _posY, _posZ, _texGridX, _texGridY, _direction), light(_light) {}
 };
\ No newline at end of file
@@ -11,6 +11,9 @@ enum FACE_DIRECTION {
     PLACEHOLDER_VALUE
 };
 
+// Directions a block face can point in, PLACEHOLDER_VALUE excluded
+constexpr int FACE_DIRECTION_COUNT = PLACEHOLDER_VALUE;
+
 struct Vertex {
     char posX, posY, posZ;
     char texGridX, texGridY;
@@ -0,0 +1,245 @@
+#include "headers/World.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+#include "headers/WorldGen.h"
+#include "headers/Lighting.h"
+#include "headers/RandomTicks.h"
+
+// Public
+World::World(const std::string& saveDirectory)
+	: fluidSimulation(*this), saveDirectory(saveDirectory),
+	streamer(jobSystem, chunkMutex, [this](ChunkPos chunkPos) { return loadChunkData(chunkPos); }, [this](ChunkPos chunkPos)
+	{
+		// Only the data is kept, so a chunk is done once it is loaded
+		chunkMutex.lock();
+		streamer.finishLoading(chunkPos);
+		chunkMutex.unlock();
+	}, false, 0),
+	jobSystem(std::max(2u, std::thread::hardware_concurrency()) - 1)
+{
+	std::filesystem::create_directories(saveDirectory);
+}
+
+World::~World()
+{
+	jobSystem.waitIdle();
+	save();
+}
+
+void World::setInterestCenters(const std::vector<glm::vec3>& positions)
+{
+	std::vector<ChunkPos> releasedChunks;
+
+	chunkMutex.lock();
+	streamer.setRange(renderDistance, renderHeight);
+	for (size_t i = 0; i < positions.size(); i++)
+	{
+		streamer.setObserver(i, ChunkPos(
+			(int)floorf(positions[i].x / CHUNK_SIZE),
+			(int)floorf(positions[i].y / CHUNK_SIZE),
+			(int)floorf(positions[i].z / CHUNK_SIZE)));
+	}
+	for (size_t i = positions.size(); i < interestCenterCount; i++)
+		streamer.removeObserver(i);
+	interestCenterCount = positions.size();
+
+	streamer.takeReleased(releasedChunks);
+	for (const ChunkPos& chunkPos : releasedChunks)
+	{
+		// Another position picked it up again, keep the data instead of loading it a second time
+		if (streamer.reclaim(chunkPos))
+			continue;
+
+		// Saved before a load job can be started for it again, so it never reads the file from before the edits
+		ChunkData* data = streamer.getData(chunkPos);
+		if (editedChunks.erase(chunkPos) > 0 && data != nullptr)
+			saveChunkData(chunkPos, data);
+
+		streamer.unload(chunkPos);
+	}
+	streamer.dispatch();
+	chunkMutex.unlock();
+}
+
+bool World::getBlock(int x, int y, int z, uint16_t& block)
+{
+	int chunkX = x < 0 ? floorf(x / (float)CHUNK_SIZE) : x / (int)CHUNK_SIZE;
+	int chunkY = y < 0 ? floorf(y / (float)CHUNK_SIZE) : y / (int)CHUNK_SIZE;
+	int chunkZ = z < 0 ? floorf(z / (float)CHUNK_SIZE) : z / (int)CHUNK_SIZE;
+
+	ChunkData* data = getChunkData({ chunkX, chunkY, chunkZ });
+	if (data == nullptr)
+		return false;
+
+	block = data->getBlock(x - chunkX * CHUNK_SIZE, y - chunkY * CHUNK_SIZE, z - chunkZ * CHUNK_SIZE);
+	return true;
+}
+
+bool World::setBlock(int x, int y, int z, uint16_t block)
+{
+	int chunkX = x < 0 ? floorf(x / (float)CHUNK_SIZE) : x / (int)CHUNK_SIZE;
+	int chunkY = y < 0 ? floorf(y / (float)CHUNK_SIZE) : y / (int)CHUNK_SIZE;
+	int chunkZ = z < 0 ? floorf(z / (float)CHUNK_SIZE) : z / (int)CHUNK_SIZE;
+
+	ChunkPos chunkPos(chunkX, chunkY, chunkZ);
+	ChunkData* data = getChunkData(chunkPos);
+	if (data == nullptr)
+		return false;
+
+	int localX = x - chunkX * CHUNK_SIZE;
+	int localY = y - chunkY * CHUNK_SIZE;
+	int localZ = z - chunkZ * CHUNK_SIZE;
+	data->setBlock(localX, localY, localZ, block);
+	// Light isn't saved or sent, the chunks it spread into need nothing else
+	std::vector<ChunkPos> relitChunks;
+	Lighting::updateBlock(chunkPos, [this](ChunkPos lightPos) { return getChunkData(lightPos); }, localX, localY, localZ, relitChunks);
+
+	blockChanges.push_back({ chunkPos, (uint16_t)(localX * CHUNK_SIZE * CHUNK_SIZE + localZ * CHUNK_SIZE + localY), block });
+	editedChunks.insert(chunkPos);
+	return true;
+}
+
+uint8_t World::getFlowLevel(int x, int y, int z)
+{
+	int chunkX = x < 0 ? floorf(x / (float)CHUNK_SIZE) : x / (int)CHUNK_SIZE;
+	int chunkY = y < 0 ? floorf(y / (float)CHUNK_SIZE) : y / (int)CHUNK_SIZE;
+	int chunkZ = z < 0 ? floorf(z / (float)CHUNK_SIZE) : z / (int)CHUNK_SIZE;
+
+	ChunkData* data = getChunkData({ chunkX, chunkY, chunkZ });
+	if (data == nullptr)
+		return 0;
+
+	return data->getFlowLevel(x - chunkX * CHUNK_SIZE, y - chunkY * CHUNK_SIZE, z - chunkZ * CHUNK_SIZE);
+}
+
+bool World::setFlowLevel(int x, int y, int z, uint8_t level)
+{
+	int chunkX = x < 0 ? floorf(x / (float)CHUNK_SIZE) : x / (int)CHUNK_SIZE;
+	int chunkY = y < 0 ? floorf(y / (float)CHUNK_SIZE) : y / (int)CHUNK_SIZE;
+	int chunkZ = z < 0 ? floorf(z / (float)CHUNK_SIZE) : z / (int)CHUNK_SIZE;
+
+	ChunkPos chunkPos(chunkX, chunkY, chunkZ);
+	ChunkData* data = getChunkData(chunkPos);
+	if (data == nullptr)
+		return false;
+
+	data->setFlowLevel(x - chunkX * CHUNK_SIZE, y - chunkY * CHUNK_SIZE, z - chunkZ * CHUNK_SIZE, level);
+	editedChunks.insert(chunkPos);
+	return true;
+}
+
+bool World::editBlock(int x, int y, int z, uint16_t block)
+{
+	if (!setBlock(x, y, z, block))
+		return false;
+
+	fluidSimulation.blockChanged(x, y, z);
+	return true;
+}
+
+void World::tick()
+{
+	tickCount++;
+
+	fluidSimulation.tick();
+
+	std::vector<std::pair<ChunkPos, ChunkData*>> loaded;
+	chunkMutex.lock();
+	loaded.assign(streamer.getAllData().begin(), streamer.getAllData().end());
+	chunkMutex.unlock();
+
+	for (auto& chunk : loaded)
+		RandomTicks::tickChunk(*this, chunk.first, chunk.second);
+}
+
+void World::save()
+{
+	for (const ChunkPos& chunkPos : editedChunks)
+	{
+		ChunkData* data = getChunkData(chunkPos);
+		if (data != nullptr)
+			saveChunkData(chunkPos, data);
+	}
+	editedChunks.clear();
+}
+
+ChunkData* World::getChunkData(ChunkPos chunkPos)
+{
+	chunkMutex.lock();
+	ChunkData* data = streamer.getData(chunkPos);
+	chunkMutex.unlock();
+	return data;
+}
+
+unsigned int World::getLoadedChunkCount()
+{
+	chunkMutex.lock();
+	unsigned int count = streamer.getAllData().size();
+	chunkMutex.unlock();
+	return count;
+}
+
+unsigned int World::getQueuedChunkCount()
+{
+	chunkMutex.lock();
+	unsigned int count = streamer.getBacklog();
+	chunkMutex.unlock();
+	return count;
+}
+
+// Private
+// Reads the chunk from the save directory, or generates it if it was never saved
+ChunkData* World::loadChunkData(ChunkPos chunkPos)
+{
+	uint16_t* d = new uint16_t[CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE];
+
+	std::ifstream file(getChunkPath(chunkPos), std::ios::binary);
+	bool saved = file && file.read((char*)d, CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE * sizeof(uint16_t));
+	if (!saved)
+		WorldGen::generateChunkData(chunkPos, d);
+
+	ChunkData* data = new ChunkData(d);
+
+	// Saves from before flow levels were stored end with the blocks, their water all loads as source water
+	uint16_t flowCount = 0;
+	if (saved && file.read((char*)&flowCount, sizeof(flowCount)))
+	{
+		for (uint16_t i = 0; i < flowCount; i++)
+		{
+			uint16_t index;
+			uint8_t level;
+			if (!file.read((char*)&index, sizeof(index)) || !file.read((char*)&level, sizeof(level)))
+				break;
+			if (index < CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE)
+				data->flowLevels[index] = level;
+		}
+	}
+
+	Lighting::generateChunkLight(chunkPos, data);
+	return data;
+}
+
+// The blocks followed by the flow levels as a count and index, level pairs
+void World::saveChunkData(ChunkPos chunkPos, ChunkData* data)
+{
+	std::ofstream file(getChunkPath(chunkPos), std::ios::binary | std::ios::trunc);
+	file.write((const char*)data->data, CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE * sizeof(uint16_t));
+
+	uint16_t flowCount = data->flowLevels.size();
+	file.write((const char*)&flowCount, sizeof(flowCount));
+	for (auto& it : data->flowLevels)
+	{
+		file.write((const char*)&it.first, sizeof(it.first));
+		file.write((const char*)&it.second, sizeof(it.second));
+	}
+}
+
+std::string World::getChunkPath(ChunkPos chunkPos) const
+{
+	return saveDirectory + "/" + std::to_string(chunkPos.x) + "_" + std::to_string(chunkPos.y) + "_" + std::to_string(chunkPos.z) + ".chunk";
+}
\ No newline at end of file
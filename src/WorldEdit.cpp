@@ -0,0 +1,317 @@
+#include "headers/WorldEdit.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "headers/Blocks.h"
+#include "headers/Lighting.h"
+#include "Chunk/headers/ChunkPosHash.h"
+
+// Relight order, top to bottom so sky light is settled above a chunk before it is relit
+struct TopDown
+{
+	bool operator()(const ChunkPos& a, const ChunkPos& b) const
+	{
+		if (a.y != b.y)
+			return a.y > b.y;
+		if (a.x != b.x)
+			return a.x < b.x;
+		return a.z < b.z;
+	}
+};
+
+static const int size = CHUNK_SIZE;
+
+static int floorDiv(int value, int divisor)
+{
+	return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+static double millisecondsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Tells the target about the blocks of the chunk's part of the box, from and to in chunk coordinates, that lie on
+// the faces of the box. Inside a filled box nothing can flow, so only the faces need the fluid system's attention.
+static void notifyFaces(const WorldEdit::EditTarget& target, glm::ivec3 chunkStart, glm::ivec3 from, glm::ivec3 to, glm::ivec3 min, glm::ivec3 max)
+{
+	for (int axis = 0; axis < 3; axis++)
+	{
+		for (int side = 0; side < 2; side++)
+		{
+			if (side == 1 && min[axis] == max[axis])
+				continue;
+
+			int face = (side == 0 ? min[axis] : max[axis]) - chunkStart[axis];
+			if (face < from[axis] || face > to[axis])
+				continue;
+
+			glm::ivec3 low = from;
+			glm::ivec3 high = to;
+			low[axis] = face;
+			high[axis] = face;
+			for (int x = low.x; x <= high.x; x++)
+			{
+				for (int z = low.z; z <= high.z; z++)
+				{
+					for (int y = low.y; y <= high.y; y++)
+						target.blockChanged(chunkStart.x + x, chunkStart.y + y, chunkStart.z + z);
+				}
+			}
+		}
+	}
+}
+
+// Runs blockFunction(x, y, z, oldBlock) -> newBlock over the box in chunk-major order, then relights and remeshes
+template <typename BlockFunction>
+static WorldEdit::EditStats editBox(glm::ivec3 min, glm::ivec3 max, const WorldEdit::EditTarget& target, BlockFunction blockFunction)
+{
+	WorldEdit::EditStats stats;
+	auto start = std::chrono::steady_clock::now();
+
+	// The box and a chunk around it, which covers everything but the chunks below that sky light reaches
+	std::vector<std::pair<ChunkPos, ChunkData*>> boxChunks;
+	target.getChunksInBox(min - size, max + size, boxChunks);
+	std::unordered_map<ChunkPos, ChunkData*, ChunkPosHash> loaded(boxChunks.begin(), boxChunks.end());
+	auto getChunkData = [&](ChunkPos chunkPos) -> ChunkData*
+	{
+		auto it = loaded.find(chunkPos);
+		if (it != loaded.end())
+			return it->second;
+
+		ChunkData* chunkData = target.getChunkData(chunkPos);
+		if (chunkData != nullptr)
+			loaded[chunkPos] = chunkData;
+		return chunkData;
+	};
+
+	std::set<ChunkPos, TopDown> relightChunks;
+	std::unordered_set<ChunkPos, ChunkPosHash> dirtyChunks;
+
+	for (int chunkX = floorDiv(min.x, size); chunkX <= floorDiv(max.x, size); chunkX++)
+	{
+		for (int chunkZ = floorDiv(min.z, size); chunkZ <= floorDiv(max.z, size); chunkZ++)
+		{
+			for (int chunkY = floorDiv(min.y, size); chunkY <= floorDiv(max.y, size); chunkY++)
+			{
+				ChunkPos chunkPos(chunkX, chunkY, chunkZ);
+				auto it = loaded.find(chunkPos);
+				ChunkData* chunkData = it != loaded.end() ? it->second : nullptr;
+				if (chunkData == nullptr)
+				{
+					stats.chunksSkipped++;
+					continue;
+				}
+
+				glm::ivec3 chunkStart(chunkX * size, chunkY * size, chunkZ * size);
+				glm::ivec3 from = glm::max(min - chunkStart, glm::ivec3(0));
+				glm::ivec3 to = glm::min(max - chunkStart, glm::ivec3(size - 1));
+
+				uint64_t changed = 0;
+				for (int x = from.x; x <= to.x; x++)
+				{
+					for (int z = from.z; z <= to.z; z++)
+					{
+						// y runs along a contiguous column of the chunk data
+						uint16_t* column = chunkData->data + (x * size + z) * size;
+						for (int y = from.y; y <= to.y; y++)
+						{
+							uint16_t block = blockFunction(chunkStart.x + x, chunkStart.y + y, chunkStart.z + z, column[y]);
+							if (block != column[y])
+							{
+								chunkData->setBlock(x, y, z, block);
+								changed++;
+							}
+						}
+					}
+				}
+
+				if (changed == 0)
+					continue;
+
+				stats.chunksEdited++;
+				stats.blocksChanged += changed;
+				relightChunks.insert(chunkPos);
+				notifyFaces(target, chunkStart, from, to, min, max);
+
+				// Border blocks show up in the neighbour's mesh too
+				dirtyChunks.insert(chunkPos);
+				if (from.x == 0)
+					dirtyChunks.insert({ chunkX - 1, chunkY, chunkZ });
+				if (to.x == size - 1)
+					dirtyChunks.insert({ chunkX + 1, chunkY, chunkZ });
+				if (from.y == 0)
+					dirtyChunks.insert({ chunkX, chunkY - 1, chunkZ });
+				if (to.y == size - 1)
+					dirtyChunks.insert({ chunkX, chunkY + 1, chunkZ });
+				if (from.z == 0)
+					dirtyChunks.insert({ chunkX, chunkY, chunkZ - 1 });
+				if (to.z == size - 1)
+					dirtyChunks.insert({ chunkX, chunkY, chunkZ + 1 });
+			}
+		}
+	}
+
+	stats.editMilliseconds = millisecondsSince(start);
+	start = std::chrono::steady_clock::now();
+
+	// Relight each chunk once, following changed sky light down into the chunks below
+	while (!relightChunks.empty())
+	{
+		ChunkPos chunkPos = *relightChunks.begin();
+		relightChunks.erase(relightChunks.begin());
+
+		ChunkData* chunkData = getChunkData(chunkPos);
+		if (chunkData == nullptr)
+			continue;
+
+		ChunkData* upData = getChunkData({ chunkPos.x, chunkPos.y + 1, chunkPos.z });
+		ChunkPos downPos(chunkPos.x, chunkPos.y - 1, chunkPos.z);
+		if (Lighting::relightChunk(chunkData, upData) && getChunkData(downPos) != nullptr)
+			relightChunks.insert(downPos);
+
+		dirtyChunks.insert(chunkPos);
+		stats.chunksRelit++;
+	}
+
+	stats.relightMilliseconds = millisecondsSince(start);
+
+	for (const ChunkPos& chunkPos : dirtyChunks)
+	{
+		if (getChunkData(chunkPos) == nullptr)
+			continue;
+
+		target.remesh(chunkPos);
+		stats.chunksRemeshed++;
+	}
+
+	return stats;
+}
+
+WorldEdit::EditStats WorldEdit::fill(const EditTarget& target, glm::ivec3 min, glm::ivec3 max, uint16_t block)
+{
+	return editBox(min, max, target, [block](int x, int y, int z, uint16_t oldBlock)
+	{
+		return block;
+	});
+}
+
+WorldEdit::EditStats WorldEdit::replace(const EditTarget& target, glm::ivec3 min, glm::ivec3 max, uint16_t fromBlock, uint16_t toBlock)
+{
+	return editBox(min, max, target, [fromBlock, toBlock](int x, int y, int z, uint16_t oldBlock)
+	{
+		return oldBlock == fromBlock ? toBlock : oldBlock;
+	});
+}
+
+WorldEdit::EditStats WorldEdit::paste(const EditTarget& target, const Schematic& schematic, glm::ivec3 position, bool pasteAir)
+{
+	glm::ivec3 max = position + glm::ivec3(schematic.sizeX, schematic.sizeY, schematic.sizeZ) - 1;
+	return editBox(position, max, target, [&schematic, position, pasteAir](int x, int y, int z, uint16_t oldBlock)
+	{
+		int index = (y - position.y) * schematic.sizeX * schematic.sizeZ + (x - position.x) * schematic.sizeZ + (z - position.z);
+		uint16_t block = schematic.blocks[index];
+		return block != Blocks::AIR || pasteAir ? block : oldBlock;
+	});
+}
+
+WorldEdit::Schematic WorldEdit::copy(const EditTarget& target, glm::ivec3 min, glm::ivec3 max)
+{
+	Schematic schematic;
+	schematic.sizeX = max.x - min.x + 1;
+	schematic.sizeY = max.y - min.y + 1;
+	schematic.sizeZ = max.z - min.z + 1;
+	schematic.blocks.assign(schematic.sizeX * schematic.sizeY * schematic.sizeZ, Blocks::AIR);
+
+	// Reading never changes a block, so nothing gets relit or remeshed
+	editBox(min, max, target, [&schematic, min](int x, int y, int z, uint16_t oldBlock)
+	{
+		int index = (y - min.y) * schematic.sizeX * schematic.sizeZ + (x - min.x) * schematic.sizeZ + (z - min.z);
+		schematic.blocks[index] = oldBlock;
+		return oldBlock;
+	});
+
+	return schematic;
+}
+
+static void printStats(const char* name, const WorldEdit::EditStats& stats)
+{
+	std::cout << name << ": " << stats.blocksChanged << " blocks in " << stats.chunksEdited << " chunks, "
+		<< stats.editMilliseconds << " ms edit, " << stats.chunksRelit << " chunks relit in " << stats.relightMilliseconds << " ms, "
+		<< stats.chunksRemeshed << " remeshes queued\n";
+}
+
+void WorldEdit::runBenchmark(int boxSize)
+{
+	int chunks = (boxSize + size - 1) / size;
+
+	// Empty chunks covering the box, lit by open sky
+	std::unordered_map<ChunkPos, ChunkData*, ChunkPosHash> chunkData;
+	for (int x = 0; x < chunks; x++)
+	{
+		for (int y = chunks - 1; y >= 0; y--)
+		{
+			for (int z = 0; z < chunks; z++)
+			{
+				ChunkData* data = new ChunkData(new uint16_t[CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE]());
+				chunkData[{ x, y, z }] = data;
+
+				auto up = chunkData.find({ x, y + 1, z });
+				Lighting::relightChunk(data, up != chunkData.end() ? up->second : nullptr);
+			}
+		}
+	}
+
+	EditTarget target{
+		[&chunkData](ChunkPos chunkPos) -> ChunkData*
+		{
+			auto it = chunkData.find(chunkPos);
+			return it != chunkData.end() ? it->second : nullptr;
+		},
+		[&chunkData](glm::ivec3 min, glm::ivec3 max, std::vector<std::pair<ChunkPos, ChunkData*>>& out)
+		{
+			for (auto& it : chunkData)
+			{
+				glm::ivec3 chunkStart = glm::ivec3(it.first.x, it.first.y, it.first.z) * size;
+				if (glm::all(glm::lessThanEqual(chunkStart, max)) && glm::all(glm::greaterThanEqual(chunkStart + size - 1, min)))
+					out.push_back(it);
+			}
+		},
+		[](ChunkPos chunkPos)
+		{
+			// Nothing to draw, editBox still counts the remeshes
+		},
+		[](int x, int y, int z)
+		{
+			// No water to wake
+		}
+	};
+
+	glm::ivec3 min(0);
+	glm::ivec3 max(boxSize - 1);
+	std::cout << "World edit benchmark, " << boxSize << "^3 blocks\n";
+
+	printStats("fill", editBox(min, max, target, [](int x, int y, int z, uint16_t oldBlock)
+	{
+		return (uint16_t)Blocks::STONE_BLOCK;
+	}));
+
+	printStats("replace", editBox(min, max, target, [](int x, int y, int z, uint16_t oldBlock)
+	{
+		return oldBlock == Blocks::STONE_BLOCK ? (uint16_t)Blocks::DIRT_BLOCK : oldBlock;
+	}));
+
+	printStats("clear", editBox(min, max, target, [](int x, int y, int z, uint16_t oldBlock)
+	{
+		return (uint16_t)Blocks::AIR;
+	}));
+
+	for (auto& it : chunkData)
+		delete it.second;
+}
\ No newline at end of file
@@ -1,484 +1,810 @@
 #include "headers/WorldGen.h"
 
 #include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <OpenSimplexNoise.hh>
 #include <random>
+#include <mutex>
+#include <queue>
 
 #include "headers/Blocks.h"
-#include "headers/Planet.h"
-
-void WorldGen::generateChunkData(ChunkPos chunkPos, uint16_t* chunkData)
-{
-	static int chunkSize = CHUNK_SIZE;
+#include "headers/Biomes.h"
+#include "Chunk/headers/ChunkData.h"
+#include "Chunk/headers/ChunkPosHash.h"
+
+static const int seed = 20;
+
+// Init noise
+static auto noise2D = OSN::Noise<2>(seed);
+static auto noise3D = OSN::Noise<3>(seed);
+
+// Init noise settings
+static NoiseSettings surfaceSettings[]{
+	{ 0.01f, 20.0f, 0 },
+	{ 0.05f,  3.0f, 0 }
+};
+static int surfaceSettingsLength = sizeof(surfaceSettings) / sizeof(*surfaceSettings);
+
+static NoiseSettings caveSettings[]{
+	{ 0.05f, 1.0f, 0, .5f, 0, 100 }
+};
+static int caveSettingsLength = sizeof(caveSettings) / sizeof(*caveSettings);
+
+static NoiseSettings oreSettings[]{
+	{ 0.075f, 1.0f, 8.54f, .75f, 1, 0 }
+};
+static int oreSettingsLength = sizeof(oreSettings) / sizeof(*oreSettings);
+
+static SurfaceFeature surfaceFeatures[]{
+	// Pond
+	{
+		{ 32, 8, .3f, 1 },					// Scatter
+		{									// Blocks
+			0, 0, 0,  0,  0,  0, 0,
+			0, 0, 0,  0,  0,  0, 0,
+			0, 0, 0,  13, 13, 0, 0,
+			0, 0, 13, 13, 13, 0, 0,
+			0, 0, 0,  13, 0,  0, 0,
+			0, 0, 0,  0,  0,  0, 0,
+			0, 0, 0,  0,  0,  0, 0,
+
+			0, 2,  13, 13, 2,  0,  0,
+			0, 2,  13, 13, 13, 2,  0,
+			2, 13, 13, 13, 13, 13, 2,
+			2, 13, 13, 13, 13, 13, 2,
+			2, 13, 13, 13, 13, 13, 2,
+			0, 2,  13, 13, 13, 2,  0,
+			0, 0,  2,  13, 2,  0,  0,
+
+			0, 0, 0, 0, 0, 0, 0,
+			0, 0, 0, 0, 0, 0, 0,
+			0, 0, 0, 0, 0, 0, 0,
+			0, 0, 0, 0, 0, 0, 0,
+			0, 0, 0, 0, 0, 0, 0,
+			0, 0, 0, 0, 0, 0, 0,
+			0, 0, 0, 0, 0, 0, 0,
+		},
+		{									// Replace?
+			false, false, false, false, false, false, false,
+			false, false, false, false, false, false, false,
+			false, false, false, true,  true,  false, false,
+			false, false, true,  true,  true,  false, false,
+			false, false, false, true,  false, false, false,
+			false, false, false, false, false, false, false,
+			false, false, false, false, false, false, false,
+
+			false, false, true,  true, false, false, false,
+			false, false, true,  true, true,  false, false,
+			false, true,  true,  true, true,  true,  false,
+			false, true,  true,  true, true,  true,  false,
+			false, true,  true,  true, true,  true,  false,
+			false, false, true,  true, true,  false, false,
+			false, false, false, true, false, false, false,
+
+			false, false, true,  true, false, false, false,
+			false, false, true,  true, true,  true,  false,
+			false, true,  true,  true, true,  true,  false,
+			false, true,  true,  true, true,  true,  false,
+			false, true,  true,  true, true,  true,  false,
+			false, false, true,  true, true,  false, false,
+			false, false, false, true, false, false, false,
+		},
+		7, 3, 7,							// Size
+		-3, -2, -3							// Offset
+	},
+	// Tree
+	{
+		{ 12, 5, .26f, 2 },
+		{
+			0, 0, 0, 0, 0,
+			0, 0, 0, 0, 0,
+			0, 0, 1, 0, 0,
+			0, 0, 0, 0, 0,
+			0, 0, 0, 0, 0,
+
+			0, 0, 0, 0, 0,
+			0, 0, 0, 0, 0,
+			0, 0, 4, 0, 0,
+			0, 0, 0, 0, 0,
+			0, 0, 0, 0, 0,
+
+			0, 0, 0, 0, 0,
+			0, 0, 0, 0, 0,
+			0, 0, 4, 0, 0,
+			0, 0, 0, 0, 0,
+			0, 0, 0, 0, 0,
+
+			0, 5, 5, 5, 0,
+			5, 5, 5, 5, 5,
+			5, 5, 4, 5, 5,
+			5, 5, 5, 5, 5,
+			0, 5, 5, 5, 0,
+
+			0, 5, 5, 5, 0,
+			5, 5, 5, 5, 5,
+			5, 5, 4, 5, 5,
+			5, 5, 5, 5, 5,
+			0, 5, 5, 5, 0,
+
+			0, 0, 0, 0, 0,
+			0, 0, 5, 0, 0,
+			0, 5, 5, 5, 0,
+			0, 0, 5, 0, 0,
+			0, 0, 0, 0, 0,
+
+			0, 0, 0, 0, 0,
+			0, 0, 5, 0, 0,
+			0, 5, 5, 5, 0,
+			0, 0, 5, 0, 0,
+			0, 0, 0, 0, 0,
 
-	// Init noise
-	static auto noise2D = OSN::Noise<2>(20);
-	static auto noise3D = OSN::Noise<3>(20);
-
-	// Init noise settings
-	static NoiseSettings surfaceSettings[]{
-		{ 0.01f, 20.0f, 0 },
-		{ 0.05f,  3.0f, 0 }
-	};
-	static int surfaceSettingsLength = sizeof(surfaceSettings) / sizeof(*surfaceSettings);
-
-	static NoiseSettings caveSettings[]{
-		{ 0.05f, 1.0f, 0, .5f, 0, 100 }
-	};
-	static int caveSettingsLength = sizeof(caveSettings) / sizeof(*caveSettings);
-
-	static NoiseSettings oreSettings[]{
-		{ 0.075f, 1.0f, 8.54f, .75f, 1, 0 }
-	};
-	static int oreSettingsLength = sizeof(oreSettings) / sizeof(*oreSettings);
-
-	static SurfaceFeature surfaceFeatures[]{
-		// Pond
+		},
 		{
-			{ 0.43f, 1.0f, 2.35f, .85f, 1, 0 },	// Noise
-			{									// Blocks
-				0, 0, 0,  0,  0,  0, 0,
-				0, 0, 0,  0,  0,  0, 0,
-				0, 0, 0,  13, 13, 0, 0,
-				0, 0, 13, 13, 13, 0, 0,
-				0, 0, 0,  13, 0,  0, 0,
-				0, 0, 0,  0,  0,  0, 0,
-				0, 0, 0,  0,  0,  0, 0,
-
-				0, 2,  13, 13, 2,  0,  0,
-				0, 2,  13, 13, 13, 2,  0,
-				2, 13, 13, 13, 13, 13, 2,
-				2, 13, 13, 13, 13, 13, 2,
-				2, 13, 13, 13, 13, 13, 2,
-				0, 2,  13, 13, 13, 2,  0,
-				0, 0,  2,  13, 2,  0,  0,
-
-				0, 0, 0, 0, 0, 0, 0,
-				0, 0, 0, 0, 0, 0, 0,
-				0, 0, 0, 0, 0, 0, 0,
-				0, 0, 0, 0, 0, 0, 0,
-				0, 0, 0, 0, 0, 0, 0,
-				0, 0, 0, 0, 0, 0, 0,
-				0, 0, 0, 0, 0, 0, 0,
-			},
-			{									// Replace?
-				false, false, false, false, false, false, false,
-				false, false, false, false, false, false, false,
-				false, false, false, true,  true,  false, false,
-				false, false, true,  true,  true,  false, false,
-				false, false, false, true,  false, false, false,
-				false, false, false, false, false, false, false,
-				false, false, false, false, false, false, false,
-
-				false, false, true,  true, false, false, false,
-				false, false, true,  true, true,  false, false,
-				false, true,  true,  true, true,  true,  false,
-				false, true,  true,  true, true,  true,  false,
-				false, true,  true,  true, true,  true,  false,
-				false, false, true,  true, true,  false, false,
-				false, false, false, true, false, false, false,
-
-				false, false, true,  true, false, false, false,
-				false, false, true,  true, true,  true,  false,
-				false, true,  true,  true, true,  true,  false,
-				false, true,  true,  true, true,  true,  false,
-				false, true,  true,  true, true,  true,  false,
-				false, false, true,  true, true,  false, false,
-				false, false, false, true, false, false, false,
-			},
-			7, 3, 7,							// Size
-			-3, -2, -3							// Offset
+			false, false, false, false, false,
+			false, false, false, false, false,
+			false, false, true,  false, false,
+			false, false, false, false, false,
+			false, false, false, false, false,
+
+			false, false, false, false, false,
+			false, false, false, false, false,
+			false, false, true,  false, false,
+			false, false, false, false, false,
+			false, false, false, false, false,
+
+			false, false, false, false, false,
+			false, false, false, false, false,
+			false, false, true,  false, false,
+			false, false, false, false, false,
+			false, false, false, false, false,
+
+			false, false, false, false, false,
+			false, false, false, false, false,
+			false, false, true,  false, false,
+			false, false, false, false, false,
+			false, false, false, false, false,
+
+			false, false, false, false, false,
+			false, false, false, false, false,
+			false, false, true,  false, false,
+			false, false, false, false, false,
+			false, false, false, false, false,
+
+			false, false, false, false, false,
+			false, false, false, false, false,
+			false, false, false, false, false,
+			false, false, false, false, false,
+			false, false, false, false, false,
+
+			false, false, false, false, false,
+			false, false, false, false, false,
+			false, false, false, false, false,
+			false, false, false, false, false,
+			false, false, false, false, false,
 		},
-		// Tree
+		5,
+		7,
+		5,
+		-2,
+		0,
+		-2
+	},
+	// Tall Grass
+	{
+		{ 4, 1, .75f, 3 },
 		{
-			{ 4.23f, 1.0f, 8.54f, .8f, 1, 0 },
-			{
-				0, 0, 0, 0, 0,
-				0, 0, 0, 0, 0,
-				0, 0, 1, 0, 0,
-				0, 0, 0, 0, 0,
-				0, 0, 0, 0, 0,
-
-				0, 0, 0, 0, 0,
-				0, 0, 0, 0, 0,
-				0, 0, 4, 0, 0,
-				0, 0, 0, 0, 0,
-				0, 0, 0, 0, 0,
-
-				0, 0, 0, 0, 0,
-				0, 0, 0, 0, 0,
-				0, 0, 4, 0, 0,
-				0, 0, 0, 0, 0,
-				0, 0, 0, 0, 0,
-
-				0, 5, 5, 5, 0,
-				5, 5, 5, 5, 5,
-				5, 5, 4, 5, 5,
-				5, 5, 5, 5, 5,
-				0, 5, 5, 5, 0,
-
-				0, 5, 5, 5, 0,
-				5, 5, 5, 5, 5,
-				5, 5, 4, 5, 5,
-				5, 5, 5, 5, 5,
-				0, 5, 5, 5, 0,
-
-				0, 0, 0, 0, 0,
-				0, 0, 5, 0, 0,
-				0, 5, 5, 5, 0,
-				0, 0, 5, 0, 0,
-				0, 0, 0, 0, 0,
-
-				0, 0, 0, 0, 0,
-				0, 0, 5, 0, 0,
-				0, 5, 5, 5, 0,
-				0, 0, 5, 0, 0,
-				0, 0, 0, 0, 0,
-
-			},
-			{
-				false, false, false, false, false,
-				false, false, false, false, false,
-				false, false, true,  false, false,
-				false, false, false, false, false,
-				false, false, false, false, false,
-
-				false, false, false, false, false,
-				false, false, false, false, false,
-				false, false, true,  false, false,
-				false, false, false, false, false,
-				false, false, false, false, false,
-
-				false, false, false, false, false,
-				false, false, false, false, false,
-				false, false, true,  false, false,
-				false, false, false, false, false,
-				false, false, false, false, false,
-
-				false, false, false, false, false,
-				false, false, false, false, false,
-				false, false, true,  false, false,
-				false, false, false, false, false,
-				false, false, false, false, false,
-
-				false, false, false, false, false,
-				false, false, false, false, false,
-				false, false, true,  false, false,
-				false, false, false, false, false,
-				false, false, false, false, false,
-
-				false, false, false, false, false,
-				false, false, false, false, false,
-				false, false, false, false, false,
-				false, false, false, false, false,
-				false, false, false, false, false,
-
-				false, false, false, false, false,
-				false, false, false, false, false,
-				false, false, false, false, false,
-				false, false, false, false, false,
-				false, false, false, false, false,
-			},
-			5,
-			7,
-			5,
-			-2,
-			0,
-			-2
+			2, 7, 8
 		},
-		// Tall Grass
 		{
-			{ 1.23f, 1.0f, 4.34f, .6f, 1, 0 },
-			{
-				2, 7, 8
-			},
-			{
-				false, false, false
-			},
-			1,
-			3,
-			1,
-			0,
-			0,
-			0
+			false, false, false
 		},
-		// Grass
+		1,
+		3,
+		1,
+		0,
+		0,
+		0
+	},
+	// Grass
+	{
+		{ 3, 1, .85f, 4 },
 		{
-			{ 2.65f, 1.0f, 8.54f, .5f, 1, 0 },
-			{
-				2, 6
-			},
-			{
-				false, false
-			},
-			1,
-			2,
-			1,
-			0,
-			0,
-			0
+			2, 6
 		},
-		// Poppy
 		{
-			{ 5.32f, 1.0f, 3.67f, .8f, 1, 0 },
-			{
-				2, 9
-			},
-			{
-				false, false
-			},
-			1,
-			2,
-			1,
-			0,
-			0,
-			0
+			false, false
 		},
-		// White Tulip
+		1,
+		2,
+		1,
+		0,
+		0,
+		0
+	},
+	// Poppy
+	{
+		{ 12, 1, .26f, 5 },
 		{
-			{ 5.57f, 1.0f, 7.654f, .8f, 1, 0 },
-			{
-				2, 10
-			},
-			{
-				false, false
-			},
-			1,
-			2,
-			1,
-			0,
-			0,
-			0
+			2, 9
 		},
-		// Pink Tulip
 		{
-			{ 4.94f, 1.0f, 2.23f, .8f, 1, 0 },
-			{
-				2, 11
-			},
-			{
-				false, false
-			},
-			1,
-			2,
-			1,
-			0,
-			0,
-			0
+			false, false
 		},
-		// Orange Tulip
+		1,
+		2,
+		1,
+		0,
+		0,
+		0
+	},
+	// White Tulip
+	{
+		{ 12, 1, .26f, 6 },
 		{
-			{ 6.32f, 1.0f, 8.2f, .85f, 1, 0 },
-			{
-				2, 12
-			},
-			{
-				false, false
-			},
-			1,
-			2,
-			1,
-			0,
-			0,
-			0
+			2, 10
 		},
-	};
-	static int surfaceFeaturesLength = sizeof(surfaceFeatures) / sizeof(*surfaceFeatures);
+		{
+			false, false
+		},
+		1,
+		2,
+		1,
+		0,
+		0,
+		0
+	},
+	// Pink Tulip
+	{
+		{ 12, 1, .26f, 7 },
+		{
+			2, 11
+		},
+		{
+			false, false
+		},
+		1,
+		2,
+		1,
+		0,
+		0,
+		0
+	},
+	// Orange Tulip
+	{
+		{ 32, 1, .2f, 8 },
+		{
+			2, 12
+		},
+		{
+			false, false
+		},
+		1,
+		2,
+		1,
+		0,
+		0,
+		0
+	},
+};
+static int surfaceFeaturesLength = sizeof(surfaceFeatures) / sizeof(*surfaceFeatures);
+
+static int waterLevel = 20;
+
+// Biomes are blended from climate samples taken every BIOME_SCALE blocks
+static const int BIOME_SCALE = 4;
+static const int BIOME_SAMPLES = WorldGen::REGION_SIZE * CHUNK_SIZE / BIOME_SCALE + 1;
+static const float BIOME_SHARPNESS = 24.0f;
+
+static NoiseSettings climateSettings[]{
+	{ 0.0025f, 1.0f,  100.0f },		// Temperature
+	{ 0.0025f, 1.0f, -100.0f }		// Humidity
+};
+
+// Everything generation shares across the chunks of a region
+struct RegionData
+{
+	std::vector<float> biomeWeights;
+	// Surface height and dominant biome of every column, x-major like chunk data
+	std::vector<int> heights;
+	std::vector<uint8_t> biomes;
+	std::vector<WorldGen::FeaturePlacement> features;
+};
+
+struct ColumnInfo
+{
+	int height;
+	int biome;
+};
 
-	static int waterLevel = 20;
+// Region cache, keyed by region position (y is unused)
+static std::unordered_map<ChunkPos, std::shared_ptr<const RegionData>, ChunkPosHash> regionCache;
+static std::queue<ChunkPos> regionOrder;
+static std::mutex regionMutex;
+static constexpr size_t MAX_CACHED_REGIONS = 64;
 
-	// Account for chunk position
-	int startX = chunkPos.x * chunkSize;
-	int startY = chunkPos.y * chunkSize;
-	int startZ = chunkPos.z * chunkSize;
+static int floorDiv(int a, int b)
+{
+	return a >= 0 ? a / b : (a - b + 1) / b;
+}
 
-	int currentIndex = 0;
-	for (int x = 0; x < chunkSize; x++)
+static void sampleClimate(RegionData& region, int startX, int startZ)
+{
+	int biomeCount = Biomes::biomes.size();
+	region.biomeWeights.resize(BIOME_SAMPLES * BIOME_SAMPLES * biomeCount);
+
+	float* weights = region.biomeWeights.data();
+	for (int sX = 0; sX < BIOME_SAMPLES; sX++)
 	{
-		for (int z = 0; z < chunkSize; z++)
+		for (int sZ = 0; sZ < BIOME_SAMPLES; sZ++)
 		{
-			// Surface noise
-			int noiseY = 15;
-			for (int i = 0; i < surfaceSettingsLength; i++)
+			int worldX = startX + sX * BIOME_SCALE;
+			int worldZ = startZ + sZ * BIOME_SCALE;
+
+			float climate[2];
+			for (int i = 0; i < 2; i++)
 			{
-				noiseY += noise2D.eval(
-					(float)((x + startX) * surfaceSettings[i].frequency) + surfaceSettings[i].offset,
-					(float)((z + startZ) * surfaceSettings[i].frequency) + surfaceSettings[i].offset)
-					* surfaceSettings[i].amplitude;
+				climate[i] = noise2D.eval(
+					(float)(worldX * climateSettings[i].frequency) + climateSettings[i].offset,
+					(float)(worldZ * climateSettings[i].frequency) + climateSettings[i].offset)
+					* climateSettings[i].amplitude;
 			}
 
-			for (int y = 0; y < chunkSize; y++)
+			// Closer biomes in climate space get exponentially more weight
+			float total = 0;
+			for (int b = 0; b < biomeCount; b++)
 			{
-				// Cave noise
-				bool cave = false;
-				for (int i = 0; i < caveSettingsLength; i++)
-				{
-					if (y + startY > caveSettings[i].maxHeight || y + startY < -50)
-						continue;
+				float dT = climate[0] - Biomes::biomes[b].temperature;
+				float dH = climate[1] - Biomes::biomes[b].humidity;
+				weights[b] = std::exp(-(dT * dT + dH * dH) * BIOME_SHARPNESS);
+				total += weights[b];
+			}
 
-					float noiseCaves = noise3D.eval(
-						(float)((x + startX) * caveSettings[i].frequency) + caveSettings[i].offset,
-						(float)((y + startY) * caveSettings[i].frequency) + caveSettings[i].offset,
-						(float)((z + startZ) * caveSettings[i].frequency) + caveSettings[i].offset)
-						* caveSettings[i].amplitude;
+			for (int b = 0; b < biomeCount; b++)
+				weights[b] /= total;
 
-					if (noiseCaves > caveSettings[i].chance)
-					{
-						cave = true;
-						break;
-					}
-				}
+			weights += biomeCount;
+		}
+	}
+}
+
+// Surface height and dominant biome of a column inside the region starting at (startX, startZ)
+static ColumnInfo getColumn(const RegionData& region, int startX, int startZ, int worldX, int worldZ)
+{
+	int biomeCount = Biomes::biomes.size();
+
+	int localX = worldX - startX;
+	int localZ = worldZ - startZ;
+	int sX = localX / BIOME_SCALE;
+	int sZ = localZ / BIOME_SCALE;
+	float tX = (localX % BIOME_SCALE) / (float)BIOME_SCALE;
+	float tZ = (localZ % BIOME_SCALE) / (float)BIOME_SCALE;
+
+	const float* w00 = &region.biomeWeights[(sX * BIOME_SAMPLES + sZ) * biomeCount];
+	const float* w01 = w00 + biomeCount;
+	const float* w10 = w00 + BIOME_SAMPLES * biomeCount;
+	const float* w11 = w10 + biomeCount;
+
+	// Bilinear blend of the surrounding samples
+	float baseHeight = 0, heightScale = 0, bestWeight = -1;
+	int biome = 0;
+	for (int b = 0; b < biomeCount; b++)
+	{
+		float w = (w00[b] * (1 - tZ) + w01[b] * tZ) * (1 - tX) + (w10[b] * (1 - tZ) + w11[b] * tZ) * tX;
+		baseHeight += w * Biomes::biomes[b].baseHeight;
+		heightScale += w * Biomes::biomes[b].heightScale;
+		if (w > bestWeight)
+		{
+			bestWeight = w;
+			biome = b;
+		}
+	}
 
-				// Step 1: Terrain Shape (surface and caves) and Ores
+	float height = baseHeight;
+	for (int i = 0; i < surfaceSettingsLength; i++)
+	{
+		height += noise2D.eval(
+			(float)(worldX * surfaceSettings[i].frequency) + surfaceSettings[i].offset,
+			(float)(worldZ * surfaceSettings[i].frequency) + surfaceSettings[i].offset)
+			* surfaceSettings[i].amplitude * heightScale;
+	}
 
-				// Sky and Caves
+	return { (int)std::floor(height), biome };
+}
 
-				if (y + startY > noiseY)
-				{
-					if (y + startY <= waterLevel)
-						chunkData[currentIndex] = Blocks::WATER;
-					else
-						chunkData[currentIndex] = Blocks::AIR;
-				}
-				else if (cave)
-					chunkData[currentIndex] = Blocks::AIR;
-				// Ground
-				else
-				{
-					bool blockSet = false;
-					for (int i = 0; i < oreSettingsLength; i++)
-					{
-						if (y + startY > oreSettings[i].maxHeight || y + startY < -48)
-							continue;
-
-						float noiseOre = noise3D.eval(
-							(float)((x + startX) * oreSettings[i].frequency) + oreSettings[i].offset,
-							(float)((y + startY) * oreSettings[i].frequency) + oreSettings[i].offset,
-							(float)((z + startZ) * oreSettings[i].frequency) + oreSettings[i].offset)
-							* oreSettings[i].amplitude;
-
-						if (noiseOre > oreSettings[i].chance)
-						{
-							chunkData[currentIndex] = oreSettings[i].block;
-							blockSet = true;
-							break;
-						}
-					}
+static bool isCave(int worldX, int worldY, int worldZ)
+{
+	for (int i = 0; i < caveSettingsLength; i++)
+	{
+		if (worldY > caveSettings[i].maxHeight)
+			continue;
 
-					if (!blockSet)
-					{
-						if (y + startY == noiseY)
-							if (noiseY > waterLevel + 1)
-								chunkData[currentIndex] = Blocks::GRASS_BLOCK;
-							else
-								chunkData[currentIndex] = Blocks::SAND;
-						else if (y + startY > 10)
-							if (noiseY > waterLevel + 1)
-								chunkData[currentIndex] = Blocks::DIRT_BLOCK;
-							else
-								chunkData[currentIndex] = Blocks::SAND;
-						else if (y + startY > -50)
-							chunkData[currentIndex] = Blocks::STONE_BLOCK;
-						else
-							chunkData[currentIndex] = Blocks::AIR;
-					}
-				}
-				currentIndex++;
-			}
+		float noiseCaves = noise3D.eval(
+			(float)(worldX * caveSettings[i].frequency) + caveSettings[i].offset,
+			(float)(worldY * caveSettings[i].frequency) + caveSettings[i].offset,
+			(float)(worldZ * caveSettings[i].frequency) + caveSettings[i].offset)
+			* caveSettings[i].amplitude;
+
+		if (noiseCaves > caveSettings[i].chance)
+			return true;
+	}
+
+	return false;
+}
+
+// Fills the world heights [fromY, toY] of a chunk column, ignoring the part outside the chunk
+static void fillRun(uint16_t* column, int startY, int fromY, int toY, uint16_t block)
+{
+	int from = std::max(fromY - startY, 0);
+	int to = std::min(toY - startY, (int)CHUNK_SIZE - 1);
+	if (from <= to)
+		std::fill(column + from, column + to + 1, block);
+}
+
+// Farthest a feature can reach outside of its anchor column
+static int getFeatureReach()
+{
+	int reach = 0;
+	for (int i = 0; i < surfaceFeaturesLength; i++)
+	{
+		reach = std::max(reach, surfaceFeatures[i].sizeX + std::abs(surfaceFeatures[i].offsetX));
+		reach = std::max(reach, surfaceFeatures[i].sizeZ + std::abs(surfaceFeatures[i].offsetZ));
+	}
+
+	return reach;
+}
+
+// Integer hash used to scatter features, so placement does not depend on thread or generation order
+static uint32_t mixHash(uint32_t h)
+{
+	h ^= h >> 16;
+	h *= 0x7feb352dU;
+	h ^= h >> 15;
+	h *= 0x846ca68bU;
+	h ^= h >> 16;
+	return h;
+}
+
+static uint32_t hashCell(uint32_t seed, int cellX, int cellZ)
+{
+	return mixHash(seed ^ mixHash((uint32_t)cellX * 0x9e3779b9U ^ mixHash((uint32_t)cellZ + 0x632be5abU)));
+}
+
+static std::shared_ptr<const RegionData> computeRegion(int regionX, int regionZ)
+{
+	auto region = std::make_shared<RegionData>();
+
+	int regionBlocks = WorldGen::REGION_SIZE * CHUNK_SIZE;
+	int startX = regionX * regionBlocks;
+	int startZ = regionZ * regionBlocks;
+
+	sampleClimate(*region, startX, startZ);
+
+	// Column heightmap, shared by every chunk of the region and by height queries
+	region->heights.resize(regionBlocks * regionBlocks);
+	region->biomes.resize(regionBlocks * regionBlocks);
+	for (int x = 0; x < regionBlocks; x++)
+	{
+		for (int z = 0; z < regionBlocks; z++)
+		{
+			ColumnInfo column = getColumn(*region, startX, startZ, startX + x, startZ + z);
+			region->heights[x * regionBlocks + z] = column.height;
+			region->biomes[x * regionBlocks + z] = column.biome;
 		}
 	}
 
-	// Step 3: Surface Features
+	// Jittered grid: every cell holds at most one candidate, kept away from the cell border by the spacing
 	for (int i = 0; i < surfaceFeaturesLength; i++)
 	{
-		for (int x = -surfaceFeatures[i].sizeX - surfaceFeatures[i].offsetX; x < chunkSize - surfaceFeatures[i].offsetX; x++)
+		const ScatterSettings& settings = surfaceFeatures[i].scatterSettings;
+		int jitterRange = std::max(settings.cellSize - settings.spacing, 1);
+
+		// Biomes can be denser than the base chance, only rolls no biome keeps are dropped up front
+		float maxDensity = 0.0f;
+		for (const Biome& biome : Biomes::biomes)
+			maxDensity = std::max(maxDensity, biome.featureDensity[i]);
+
+		int minCellX = floorDiv(startX, settings.cellSize);
+		int maxCellX = floorDiv(startX + regionBlocks - 1, settings.cellSize);
+		int minCellZ = floorDiv(startZ, settings.cellSize);
+		int maxCellZ = floorDiv(startZ + regionBlocks - 1, settings.cellSize);
+
+		for (int cellX = minCellX; cellX <= maxCellX; cellX++)
 		{
-			for (int z = -surfaceFeatures[i].sizeZ - surfaceFeatures[i].offsetZ; z < chunkSize - surfaceFeatures[i].offsetZ; z++)
+			for (int cellZ = minCellZ; cellZ <= maxCellZ; cellZ++)
 			{
-				int noiseY = 15;
-				for (int s = 0; s < surfaceSettingsLength; s++)
-				{
-					noiseY += noise2D.eval(
-						(float)((x + startX) * surfaceSettings[s].frequency) + surfaceSettings[s].offset,
-						(float)((z + startZ) * surfaceSettings[s].frequency) + surfaceSettings[s].offset)
-						* surfaceSettings[s].amplitude;
-				}
+				uint32_t h = hashCell(seed ^ mixHash(settings.seed), cellX, cellZ);
+				float roll = (h >> 8) * (1.0f / 16777216.0f);
+				if (roll >= settings.chance * maxDensity)
+					continue;
 
-				if (noiseY + surfaceFeatures[i].offsetY > startY + chunkSize || noiseY + surfaceFeatures[i].sizeY + surfaceFeatures[i].offsetY < startY)
+				h = mixHash(h);
+				int x = cellX * settings.cellSize + settings.spacing / 2 + (int)(h % jitterRange);
+				h = mixHash(h);
+				int z = cellZ * settings.cellSize + settings.spacing / 2 + (int)(h % jitterRange);
+
+				// Cells can straddle regions, the point belongs to the region it lands in
+				if (x < startX || x >= startX + regionBlocks || z < startZ || z >= startZ + regionBlocks)
+					continue;
+
+				int columnIndex = (x - startX) * regionBlocks + (z - startZ);
+				int height = region->heights[columnIndex];
+
+				// Each biome thins out or drops the features it doesn't want
+				if (roll >= settings.chance * Biomes::biomes[region->biomes[columnIndex]].featureDensity[i])
 					continue;
 
 				// Check if it's in water or on sand
-				if (noiseY < waterLevel + 2)
+				if (height < waterLevel + 2)
 					continue;
 
 				// Check if it's in a cave
-				bool cave = false;
-				for (int i = 0; i < caveSettingsLength; i++)
+				if (isCave(x, height, z))
+					continue;
+
+				region->features.push_back({ i, x, height, z });
+			}
+		}
+	}
+
+	return region;
+}
+
+static std::shared_ptr<const RegionData> getRegion(int regionX, int regionZ)
+{
+	ChunkPos regionPos(regionX, 0, regionZ);
+
+	regionMutex.lock();
+	auto it = regionCache.find(regionPos);
+	if (it != regionCache.end())
+	{
+		auto region = it->second;
+		regionMutex.unlock();
+		return region;
+	}
+	regionMutex.unlock();
+
+	auto region = computeRegion(regionX, regionZ);
+
+	regionMutex.lock();
+	auto inserted = regionCache.emplace(regionPos, region);
+	if (inserted.second)
+	{
+		// Evict the oldest regions once the cache is full
+		regionOrder.push(regionPos);
+		while (regionOrder.size() > MAX_CACHED_REGIONS)
+		{
+			regionCache.erase(regionOrder.front());
+			regionOrder.pop();
+		}
+	}
+	else
+	{
+		// Another thread finished this region first
+		region = inserted.first->second;
+	}
+	regionMutex.unlock();
+
+	return region;
+}
+
+std::shared_ptr<const std::vector<WorldGen::FeaturePlacement>> WorldGen::getRegionFeatures(int regionX, int regionZ)
+{
+	auto region = getRegion(regionX, regionZ);
+	return std::shared_ptr<const std::vector<FeaturePlacement>>(region, &region->features);
+}
+
+// Region holding world column (x, z) and the column's index in it
+static const RegionData& getColumnRegion(int x, int z, int& columnIndex)
+{
+	int regionBlocks = WorldGen::REGION_SIZE * CHUNK_SIZE;
+	int regionX = floorDiv(x, regionBlocks);
+	int regionZ = floorDiv(z, regionBlocks);
+
+	// Queries tend to stay in one region, so skip the shared cache lock while they do
+	static thread_local std::shared_ptr<const RegionData> region;
+	static thread_local int lastRegionX, lastRegionZ;
+	if (!region || regionX != lastRegionX || regionZ != lastRegionZ)
+	{
+		region = getRegion(regionX, regionZ);
+		lastRegionX = regionX;
+		lastRegionZ = regionZ;
+	}
+
+	columnIndex = (x - regionX * regionBlocks) * regionBlocks + (z - regionZ * regionBlocks);
+	return *region;
+}
+
+int WorldGen::surfaceHeight(int x, int z)
+{
+	int columnIndex;
+	const RegionData& region = getColumnRegion(x, z, columnIndex);
+	return region.heights[columnIndex];
+}
+
+int WorldGen::surfaceBiome(int x, int z)
+{
+	int columnIndex;
+	const RegionData& region = getColumnRegion(x, z, columnIndex);
+	return region.biomes[columnIndex];
+}
+
+void WorldGen::surfaceHeights(int startX, int startZ, int sizeX, int sizeZ, int* heights)
+{
+	int regionBlocks = REGION_SIZE * CHUNK_SIZE;
+
+	// Copy whole rows out of every region the area touches
+	for (int regionX = floorDiv(startX, regionBlocks); regionX <= floorDiv(startX + sizeX - 1, regionBlocks); regionX++)
+	{
+		for (int regionZ = floorDiv(startZ, regionBlocks); regionZ <= floorDiv(startZ + sizeZ - 1, regionBlocks); regionZ++)
+		{
+			auto region = getRegion(regionX, regionZ);
+			int regionStartX = regionX * regionBlocks;
+			int regionStartZ = regionZ * regionBlocks;
+
+			int fromX = std::max(startX, regionStartX);
+			int toX = std::min(startX + sizeX, regionStartX + regionBlocks);
+			int fromZ = std::max(startZ, regionStartZ);
+			int toZ = std::min(startZ + sizeZ, regionStartZ + regionBlocks);
+
+			for (int x = fromX; x < toX; x++)
+			{
+				const int* row = &region->heights[(x - regionStartX) * regionBlocks + (fromZ - regionStartZ)];
+				std::copy(row, row + (toZ - fromZ), heights + (x - startX) * sizeZ + (fromZ - startZ));
+			}
+		}
+	}
+}
+
+void WorldGen::clearRegionCache()
+{
+	regionMutex.lock();
+	regionCache.clear();
+	regionOrder = {};
+	regionMutex.unlock();
+}
+
+void WorldGen::generateChunkData(ChunkPos chunkPos, uint16_t* chunkData)
+{
+	static int chunkSize = CHUNK_SIZE;
+	static int featureReach = getFeatureReach();
+
+	// Account for chunk position
+	int startX = chunkPos.x * chunkSize;
+	int startY = chunkPos.y * chunkSize;
+	int startZ = chunkPos.z * chunkSize;
+
+	// A chunk never straddles regions, so one lookup covers every column
+	int chunkRegionX = floorDiv(chunkPos.x, REGION_SIZE);
+	int chunkRegionZ = floorDiv(chunkPos.z, REGION_SIZE);
+	auto region = getRegion(chunkRegionX, chunkRegionZ);
+	int regionBlocks = REGION_SIZE * chunkSize;
+	int regionOffsetX = startX - chunkRegionX * regionBlocks;
+	int regionOffsetZ = startZ - chunkRegionZ * regionBlocks;
+
+	int endY = startY + chunkSize - 1;
+	for (int x = 0; x < chunkSize; x++)
+	{
+		for (int z = 0; z < chunkSize; z++)
+		{
+			// Surface noise, blended between biomes
+			int columnIndex = (x + regionOffsetX) * regionBlocks + z + regionOffsetZ;
+			const Biome& biome = Biomes::biomes[region->biomes[columnIndex]];
+			int noiseY = region->heights[columnIndex];
+
+			// Step 1: Terrain Shape
+			// The column is written as runs of world heights, each clamped to this chunk
+			uint16_t* column = chunkData + x * chunkSize * chunkSize + z * chunkSize;
+			bool dry = noiseY > waterLevel + 1;
+
+			fillRun(column, startY, startY, std::min(-50, noiseY - 1), Blocks::AIR);
+			fillRun(column, startY, -49, std::min(10, noiseY - 1), Blocks::STONE_BLOCK);
+			fillRun(column, startY, 11, noiseY - 1, dry ? biome.fillerBlock : Blocks::SAND);
+			fillRun(column, startY, noiseY, noiseY, dry ? biome.topBlock : Blocks::SAND);
+			fillRun(column, startY, noiseY + 1, waterLevel, Blocks::WATER);
+			fillRun(column, startY, std::max(noiseY + 1, waterLevel + 1), endY, Blocks::AIR);
+
+			// Step 2: Caves and Ores, only inside the solid run
+			int carveStart = std::max(startY, -50);
+			int carveEnd = std::min(noiseY, endY);
+			for (int y = carveStart; y <= carveEnd; y++)
+			{
+				if (isCave(x + startX, y, z + startZ))
+				{
+					column[y - startY] = Blocks::AIR;
+					continue;
+				}
+
+				for (int i = 0; i < oreSettingsLength; i++)
 				{
-					if (noiseY + startY > caveSettings[i].maxHeight)
+					if (y > oreSettings[i].maxHeight || y < -48)
 						continue;
 
-					float noiseCaves = noise3D.eval(
-						(float)((x + startX) * caveSettings[i].frequency) + caveSettings[i].offset,
-						(float)((noiseY) * caveSettings[i].frequency) + caveSettings[i].offset,
-						(float)((z + startZ) * caveSettings[i].frequency) + caveSettings[i].offset)
-						* caveSettings[i].amplitude;
+					float noiseOre = noise3D.eval(
+						(float)((x + startX) * oreSettings[i].frequency) + oreSettings[i].offset,
+						(float)(y * oreSettings[i].frequency) + oreSettings[i].offset,
+						(float)((z + startZ) * oreSettings[i].frequency) + oreSettings[i].offset)
+						* oreSettings[i].amplitude;
 
-					if (noiseCaves > caveSettings[i].chance)
+					if (noiseOre > oreSettings[i].chance)
 					{
-						cave = true;
+						column[y - startY] = oreSettings[i].block;
 						break;
 					}
 				}
+			}
+		}
+	}
+
+	// Step 3: Surface Features
+	// Placements come from the shared region pass, so only the ones touching this chunk are stamped
+	int minRegionX = floorDiv(startX - featureReach, regionBlocks);
+	int maxRegionX = floorDiv(startX + chunkSize + featureReach, regionBlocks);
+	int minRegionZ = floorDiv(startZ - featureReach, regionBlocks);
+	int maxRegionZ = floorDiv(startZ + chunkSize + featureReach, regionBlocks);
+
+	std::vector<FeaturePlacement> placements;
+	for (int regionX = minRegionX; regionX <= maxRegionX; regionX++)
+	{
+		for (int regionZ = minRegionZ; regionZ <= maxRegionZ; regionZ++)
+		{
+			auto regionPlacements = getRegionFeatures(regionX, regionZ);
+			for (const FeaturePlacement& placement : *regionPlacements)
+			{
+				const SurfaceFeature& feature = surfaceFeatures[placement.featureId];
 
-				if (cave)
+				if (placement.x + feature.offsetX + feature.sizeX <= startX || placement.x + feature.offsetX >= startX + chunkSize)
+					continue;
+				if (placement.z + feature.offsetZ + feature.sizeZ <= startZ || placement.z + feature.offsetZ >= startZ + chunkSize)
+					continue;
+				if (placement.y + feature.offsetY > startY + chunkSize || placement.y + feature.sizeY + feature.offsetY < startY)
 					continue;
 
-				float noise = noise2D.eval(
-					(float)((x + startX) * surfaceFeatures[i].noiseSettings.frequency) + surfaceFeatures[i].noiseSettings.offset,
-					(float)((z + startZ) * surfaceFeatures[i].noiseSettings.frequency) + surfaceFeatures[i].noiseSettings.offset);
+				placements.push_back(placement);
+			}
+		}
+	}
 
-				if (noise > surfaceFeatures[i].noiseSettings.chance)
+	// Stamp in feature order, then column order, so overlapping features resolve the same way everywhere
+	std::sort(placements.begin(), placements.end(), [](const FeaturePlacement& a, const FeaturePlacement& b)
+	{
+		if (a.featureId != b.featureId)
+			return a.featureId < b.featureId;
+		if (a.x != b.x)
+			return a.x < b.x;
+		return a.z < b.z;
+	});
+
+	for (const FeaturePlacement& placement : placements)
+	{
+		const SurfaceFeature& feature = surfaceFeatures[placement.featureId];
+
+		for (int fX = 0; fX < feature.sizeX; fX++)
+		{
+			for (int fY = 0; fY < feature.sizeY; fY++)
+			{
+				for (int fZ = 0; fZ < feature.sizeZ; fZ++)
 				{
-					int featureX = x + startX;
-					int featureY = noiseY;
-					int featureZ = z + startZ;
+					int localX = placement.x + fX + feature.offsetX - startX;
+					int localY = placement.y + fY + feature.offsetY - startY;
+					int localZ = placement.z + fZ + feature.offsetZ - startZ;
 
-					for (int fX = 0; fX < surfaceFeatures[i].sizeX; fX++)
-					{
-						for (int fY = 0; fY < surfaceFeatures[i].sizeY; fY++)
-						{
-							for (int fZ = 0; fZ < surfaceFeatures[i].sizeZ; fZ++)
-				 			{
-								int localX = featureX + fX + surfaceFeatures[i].offsetX - startX;
-								//std::cout << "FeatureX: " << featureX << ", fX: " << fX << ", startX: " << startX << ", localX: " << localX << '\n';
-								int localY = featureY + fY + surfaceFeatures[i].offsetY - startY;
-								//std::cout << "FeatureY: " << featureY << ", fY: " << fY << ", startY: " << startY << ", localY: " << localY << '\n';
-								int localZ = featureZ + fZ + surfaceFeatures[i].offsetZ - startZ;
-								//std::cout << "FeatureZ: " << featureZ << ", fZ: " << fZ << ", startZ: " << startZ << ", localZ: " << localZ << '\n';
-
-								if (localX >= chunkSize || localX < 0)
-									continue;
-								if (localY >= chunkSize || localY < 0)
-									continue;
-								if (localZ >= chunkSize || localZ < 0)
-									continue;
-
-								int featureIndex = fY * surfaceFeatures[i].sizeX * surfaceFeatures[i].sizeZ +
-									fX * surfaceFeatures[i].sizeZ  +
-									fZ;
-								//std::cout << "Feature Index: " << featureIndex << '\n';
-								int localIndex = localX * chunkSize * chunkSize + localZ * chunkSize + localY;
-								//std::cout << "Local Index: " << localIndex << ", Max Index: " << chunkData->size() << '\n';
-
-								if (surfaceFeatures[i].replaceBlock[featureIndex] || chunkData[localIndex] == 0)
-									chunkData[localIndex] = surfaceFeatures[i].blocks[featureIndex];
-							}
-						}
-					}
+					if (localX >= chunkSize || localX < 0)
+						continue;
+					if (localY >= chunkSize || localY < 0)
+						continue;
+					if (localZ >= chunkSize || localZ < 0)
+						continue;
+
+					int featureIndex = fY * feature.sizeX * feature.sizeZ +
+						fX * feature.sizeZ +
+						fZ;
+					int localIndex = localX * chunkSize * chunkSize + localZ * chunkSize + localY;
+
+					if (feature.replaceBlock[featureIndex] || chunkData[localIndex] == 0)
+						chunkData[localIndex] = feature.blocks[featureIndex];
 				}
 			}
 		}
 	}
-}
+}
\ No newline at end of file
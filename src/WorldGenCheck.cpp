@@ -0,0 +1,156 @@
+#include "headers/WorldGenCheck.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "Chunk/headers/ChunkData.h"
+#include "headers/WorldGen.h"
+#include "headers/Biomes.h"
+
+struct GoldenChunk
+{
+	ChunkPos chunkPos;
+	uint64_t fingerprint;
+};
+
+// Spread over every biome, both signs of each axis and several heights
+static const GoldenChunk goldenChunks[]{
+	{ {   0,  0,   0 }, 0xC50D6E3EA9144B6EULL },
+	{ {   0, -1,   0 }, 0xF9F895E0C7ECEE4AULL },
+	{ {   0,  1,   0 }, 0x8F6955BF94EC2325ULL },
+	{ {  -1,  0,  -1 }, 0x4847C0E779E7DD97ULL },
+	{ {   5,  0,  -3 }, 0x167C67FD41695D2AULL },
+	{ { -12,  0,   7 }, 0xEB4E30ABDB975143ULL },
+	{ { -25, -2, -10 }, 0x3CE8558567D6BEF6ULL },
+	{ {  25,  0, -10 }, 0x24997A9EC80181AEULL },
+	{ {  20,  1, -12 }, 0x1617256FD940EC33ULL },
+	{ { -20,  0, -12 }, 0x2A7E22F113E7E149ULL },
+	{ {  10,  0,  10 }, 0x3B941F808D8CB135ULL },
+	{ {  -7,  0,  -9 }, 0x9CB61F45D5988871ULL },
+	{ {   3, -2,  11 }, 0xB64749B8C5346927ULL },
+	{ {  17,  0,   5 }, 0x7F5AA7ECFDD9F111ULL },
+	{ { -30,  0,   0 }, 0x47084698FBE7A96BULL },
+	{ {  29,  0,  11 }, 0x9E152659F1F401B6ULL },
+};
+static const int goldenChunksLength = sizeof(goldenChunks) / sizeof(*goldenChunks);
+
+// Trees per column in forests against plains, over the regions around the origin. Densities above 1 must raise
+// the placements past the base chance, so the ratio has to come close to the ratio of the biome densities.
+static bool checkFeatureDensity()
+{
+	const int treeFeature = 1;
+	const int range = 6;
+	const int regionBlocks = WorldGen::REGION_SIZE * CHUNK_SIZE;
+
+	unsigned int columns[2] = {}, trees[2] = {};
+	const int biomes[2] = { Biomes::FOREST, Biomes::PLAINS };
+	for (int regionX = -range; regionX < range; regionX++)
+	{
+		for (int regionZ = -range; regionZ < range; regionZ++)
+		{
+			for (int x = 0; x < regionBlocks; x++)
+			{
+				for (int z = 0; z < regionBlocks; z++)
+				{
+					int biome = WorldGen::surfaceBiome(regionX * regionBlocks + x, regionZ * regionBlocks + z);
+					for (int b = 0; b < 2; b++)
+						columns[b] += biome == biomes[b];
+				}
+			}
+
+			for (const WorldGen::FeaturePlacement& placement : *WorldGen::getRegionFeatures(regionX, regionZ))
+			{
+				if (placement.featureId != treeFeature)
+					continue;
+
+				int biome = WorldGen::surfaceBiome(placement.x, placement.z);
+				for (int b = 0; b < 2; b++)
+					trees[b] += biome == biomes[b];
+			}
+		}
+	}
+
+	float forestTrees = trees[0] * 1000.0f / std::max(columns[0], 1u);
+	float plainsTrees = trees[1] * 1000.0f / std::max(columns[1], 1u);
+	float expected = Biomes::biomes[Biomes::FOREST].featureDensity[treeFeature] / Biomes::biomes[Biomes::PLAINS].featureDensity[treeFeature];
+	bool passed = forestTrees > plainsTrees * expected * 0.5f;
+
+	std::cout << "Trees per 1000 columns: forest " << forestTrees << ", plains " << plainsTrees
+		<< " (" << (passed ? "passed" : "FAILED") << ")\n";
+	return passed;
+}
+
+uint64_t WorldGenCheck::fingerprint(const uint16_t* chunkData)
+{
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for (unsigned int i = 0; i < CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE; i++)
+	{
+		hash ^= chunkData[i];
+		hash *= 0x100000001b3ULL;
+	}
+
+	return hash;
+}
+
+bool WorldGenCheck::run(unsigned int threadCount)
+{
+	// Start cold, so results can't lean on regions cached by an earlier run
+	WorldGen::clearRegionCache();
+
+	std::vector<uint64_t> results(goldenChunksLength);
+
+	if (threadCount == 0)
+	{
+		uint16_t* d = new uint16_t[CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE];
+		for (int i = 0; i < goldenChunksLength; i++)
+		{
+			WorldGen::generateChunkData(goldenChunks[i].chunkPos, d);
+			results[i] = fingerprint(d);
+		}
+		delete[] d;
+	}
+	else
+	{
+		// Workers pull chunks in an order that changes with the thread count
+		std::atomic<int> next(0);
+		std::vector<std::thread> workers;
+		for (unsigned int t = 0; t < threadCount; t++)
+		{
+			workers.emplace_back([&]()
+			{
+				uint16_t* d = new uint16_t[CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE];
+				int n;
+				while ((n = next++) < goldenChunksLength)
+				{
+					int i = (n * 7 + threadCount) % goldenChunksLength;
+					WorldGen::generateChunkData(goldenChunks[i].chunkPos, d);
+					results[i] = fingerprint(d);
+				}
+				delete[] d;
+			});
+		}
+
+		for (std::thread& worker : workers)
+			worker.join();
+	}
+
+	bool passed = true;
+	for (int i = 0; i < goldenChunksLength; i++)
+	{
+		if (results[i] == goldenChunks[i].fingerprint)
+			continue;
+
+		passed = false;
+		const ChunkPos& pos = goldenChunks[i].chunkPos;
+		char line[96];
+		snprintf(line, sizeof(line), "{ { %3d, %2d, %3d }, 0x%016llXULL },", pos.x, pos.y, pos.z, (unsigned long long)results[i]);
+		std::cout << "Fingerprint mismatch (" << threadCount << " threads): " << line << '\n';
+	}
+
+	std::cout << "World generation check with " << threadCount << " threads: " << (passed ? "passed" : "FAILED") << '\n';
+	return checkFeatureDensity() && passed;
+}
\ No newline at end of file
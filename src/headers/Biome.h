@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+struct Biome
+{
+public:
+	// Point in temperature/humidity space this biome is centered on
+	float temperature, humidity;
+	float baseHeight;
+	float heightScale;
+	unsigned int topBlock, fillerBlock;
+	// Chance multiplier for every surface feature, in WorldGen feature order
+	std::vector<float> featureDensity;
+	std::string biomeName;
+
+	Biome(float temperature, float humidity, float baseHeight, float heightScale,
+		unsigned int topBlock, unsigned int fillerBlock, std::vector<float> featureDensity, std::string biomeName);
+};
\ No newline at end of file
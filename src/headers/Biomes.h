@@ -0,0 +1,32 @@
+#pragma once
+
+#include <vector>
+
+#include "Biome.h"
+#include "Blocks.h"
+
+namespace Biomes
+{
+    // Feature density order: pond, tree, tall grass, grass, poppy, white tulip, pink tulip, orange tulip
+    const std::vector<Biome> biomes{
+        Biome( 0.0f,  0.0f, 21.0f, 1.0f, Blocks::GRASS_BLOCK, Blocks::DIRT_BLOCK,
+               { 1.0f, 0.3f, 1.5f, 1.2f, 1.0f, 1.0f, 1.0f, 1.0f }, "Plains"),
+        Biome( 0.1f,  0.45f, 22.0f, 1.2f, Blocks::GRASS_BLOCK, Blocks::DIRT_BLOCK,
+               { 1.0f, 4.0f, 0.8f, 1.0f, 0.5f, 0.5f, 0.5f, 0.5f }, "Forest"),
+        Biome( 0.5f, -0.45f, 23.0f, 0.4f, Blocks::SAND, Blocks::SAND,
+               { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f }, "Desert"),
+        Biome(-0.1f,  0.75f,  4.0f, 0.5f, Blocks::SAND, Blocks::SAND,
+               { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f }, "Ocean"),
+        Biome(-0.5f, -0.2f, 30.0f, 2.5f, Blocks::GRASS_BLOCK, Blocks::STONE_BLOCK,
+               { 0.0f, 0.5f, 0.5f, 0.5f, 0.2f, 0.2f, 0.2f, 0.2f }, "Mountains"),
+    };
+
+    enum BIOMES
+    {
+        PLAINS = 0,
+        FOREST = 1,
+        DESERT = 2,
+        OCEAN = 3,
+        MOUNTAINS = 4,
+    };
+}
\ No newline at end of file
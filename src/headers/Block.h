@@ -19,6 +19,8 @@ public:
 	char sideMinX, sideMinY, sideMaxX, sideMaxY;
 	BLOCK_TYPE blockType;
 	std::string blockName;
+	// Block light level this block emits, 0-15
+	unsigned char lightEmission = 0;
 
 	Block(char minX, char minY, char maxX, char maxY, BLOCK_TYPE blockType, std::string blockName);
 	Block(char topMinX, char topMinY, char topMaxX, char topMaxY,
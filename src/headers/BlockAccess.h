@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+
+// Milliseconds per world tick
+constexpr float TICK_LENGTH = 50.0f;
+
+// World position block access, implemented by the rendered Planet and the headless World
+// so the tick systems run the same on both
+class BlockAccess
+{
+public:
+	virtual ~BlockAccess() {}
+
+	// False if the block's chunk is not loaded
+	virtual bool getBlock(int x, int y, int z, uint16_t& block) = 0;
+	// Sets and relights the block, false if the block's chunk is not loaded
+	virtual bool setBlock(int x, int y, int z, uint16_t block) = 0;
+
+	// Flow level of the water at the block, 0 for source water, anything else or an unloaded chunk
+	virtual uint8_t getFlowLevel(int x, int y, int z) = 0;
+	// Stored with the chunk so it is saved and unloaded along with it, false if the chunk is not loaded
+	virtual bool setFlowLevel(int x, int y, int z, uint8_t level) = 0;
+};
\ No newline at end of file
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Compact encoding of a chunk's blocks for sending over the network.
+// A palette of the distinct block ids, then either bit-packed palette indices or runs of them,
+// whichever is smaller. Layout: encoding (u8), palette size (u16), palette (u16 each), payload. Little endian.
+namespace ChunkCodec
+{
+	enum ENCODING : uint8_t
+	{
+		SINGLE,		// The whole chunk is the one palette block, no payload
+		PACKED,		// CHUNK_SIZE^3 indices, each using just enough bits for the palette
+		RUNS		// Varint run length followed by varint palette index, in chunk data order
+	};
+
+	// Appends the encoded blocks to out
+	void encode(const uint16_t* blocks, std::vector<uint8_t>& out);
+
+	// Decodes straight into blocks (CHUNK_SIZE^3 of them), returns how many bytes were read or 0 if the data is malformed
+	size_t decode(const uint8_t* bytes, size_t size, uint16_t* blocks);
+}
\ No newline at end of file
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <unordered_map>
+#include <glm/glm.hpp>
+
+#include "../Chunk/headers/ChunkPos.h"
+#include "../Chunk/headers/ChunkPosHash.h"
+#include "../Chunk/headers/ChunkData.h"
+
+// Chunks grouped into cells of CELL_CHUNKS^3 chunks, so culling can reject a whole cell at once and box or radius
+// queries only look at the cells they overlap instead of every chunk. T is a pointer type, nullptr for no chunk.
+// Not thread safe, the owner guards it with its chunk mutex.
+template <typename T>
+class ChunkIndex
+{
+public:
+	static constexpr int CELL_CHUNKS = 4;
+	static constexpr int CELL_BLOCKS = CELL_CHUNKS * CHUNK_SIZE;
+
+	struct Cell
+	{
+		// Position in cells
+		ChunkPos position;
+		unsigned int count = 0;
+		// Indexed x * CELL_CHUNKS^2 + y * CELL_CHUNKS + z by the chunk position inside the cell
+		T chunks[CELL_CHUNKS * CELL_CHUNKS * CELL_CHUNKS] = {};
+
+		glm::vec3 getMin() const
+		{
+			return glm::vec3(position.x, position.y, position.z) * (float)CELL_BLOCKS;
+		}
+
+		glm::vec3 getMax() const
+		{
+			return getMin() + glm::vec3(CELL_BLOCKS);
+		}
+	};
+
+	T find(ChunkPos chunkPos) const
+	{
+		auto it = cells.find(getCellPos(chunkPos));
+		return it == cells.end() ? nullptr : it->second.chunks[getSlot(chunkPos)];
+	}
+
+	// Replaces any chunk already at the position
+	void insert(ChunkPos chunkPos, T chunk)
+	{
+		Cell& cell = cells[getCellPos(chunkPos)];
+		cell.position = getCellPos(chunkPos);
+		T& slot = cell.chunks[getSlot(chunkPos)];
+		if (slot == nullptr)
+		{
+			cell.count++;
+			count++;
+		}
+		slot = chunk;
+	}
+
+	void erase(ChunkPos chunkPos)
+	{
+		auto it = cells.find(getCellPos(chunkPos));
+		if (it == cells.end())
+			return;
+
+		T& slot = it->second.chunks[getSlot(chunkPos)];
+		if (slot == nullptr)
+			return;
+
+		slot = nullptr;
+		count--;
+		if (--it->second.count == 0)
+			cells.erase(it);
+	}
+
+	size_t size() const
+	{
+		return count;
+	}
+
+	// Calls visit(const Cell&) for every cell holding a chunk
+	template <typename Visit>
+	void forEachCell(Visit visit) const
+	{
+		for (auto& it : cells)
+			visit(it.second);
+	}
+
+	// Calls visit(T) for every chunk of the cell
+	template <typename Visit>
+	static void forEachInCell(const Cell& cell, Visit visit)
+	{
+		for (T chunk : cell.chunks)
+		{
+			if (chunk != nullptr)
+				visit(chunk);
+		}
+	}
+
+	// Calls visit(T) for every chunk
+	template <typename Visit>
+	void forEach(Visit visit) const
+	{
+		for (auto& it : cells)
+			forEachInCell(it.second, visit);
+	}
+
+	// Calls visit(T) for every chunk overlapping the box of world positions
+	template <typename Visit>
+	void forEachInBox(glm::vec3 min, glm::vec3 max, Visit visit) const
+	{
+		forEachPositionInBox(min, max, [&](ChunkPos, T chunk) { visit(chunk); });
+	}
+
+	// Calls visit(T) for every chunk with any part within radius blocks of center
+	template <typename Visit>
+	void forEachInRadius(glm::vec3 center, float radius, Visit visit) const
+	{
+		forEachPositionInBox(center - glm::vec3(radius), center + glm::vec3(radius), [&](ChunkPos chunkPos, T chunk)
+		{
+			glm::vec3 min = glm::vec3(chunkPos.x, chunkPos.y, chunkPos.z) * (float)CHUNK_SIZE;
+			glm::vec3 offset = glm::clamp(center, min, min + glm::vec3(CHUNK_SIZE)) - center;
+			if (glm::dot(offset, offset) <= radius * radius)
+				visit(chunk);
+		});
+	}
+
+private:
+	// Calls visit(ChunkPos, T) for every chunk overlapping the box
+	template <typename Visit>
+	void forEachPositionInBox(glm::vec3 min, glm::vec3 max, Visit visit) const
+	{
+		ChunkPos minChunk = getChunkPos(min);
+		ChunkPos maxChunk = getChunkPos(max);
+		ChunkPos minCell = getCellPos(minChunk);
+		ChunkPos maxCell = getCellPos(maxChunk);
+
+		auto visitCell = [&](const Cell& cell)
+		{
+			ChunkPos first = ChunkPos(cell.position.x * CELL_CHUNKS, cell.position.y * CELL_CHUNKS, cell.position.z * CELL_CHUNKS);
+			for (int x = std::max(minChunk.x, first.x); x <= std::min(maxChunk.x, first.x + CELL_CHUNKS - 1); x++)
+			{
+				for (int y = std::max(minChunk.y, first.y); y <= std::min(maxChunk.y, first.y + CELL_CHUNKS - 1); y++)
+				{
+					for (int z = std::max(minChunk.z, first.z); z <= std::min(maxChunk.z, first.z + CELL_CHUNKS - 1); z++)
+					{
+						T chunk = cell.chunks[getSlot(ChunkPos(x, y, z))];
+						if (chunk != nullptr)
+							visit(ChunkPos(x, y, z), chunk);
+					}
+				}
+			}
+		};
+
+		// Small boxes look their cells up, boxes covering more cells than are loaded walk the loaded ones
+		long long cellCount = (long long)(maxCell.x - minCell.x + 1) * (maxCell.y - minCell.y + 1) * (maxCell.z - minCell.z + 1);
+		if (cellCount > (long long)cells.size())
+		{
+			for (auto& it : cells)
+			{
+				const ChunkPos& position = it.second.position;
+				if (position.x >= minCell.x && position.x <= maxCell.x && position.y >= minCell.y && position.y <= maxCell.y &&
+					position.z >= minCell.z && position.z <= maxCell.z)
+					visitCell(it.second);
+			}
+			return;
+		}
+
+		for (int x = minCell.x; x <= maxCell.x; x++)
+		{
+			for (int y = minCell.y; y <= maxCell.y; y++)
+			{
+				for (int z = minCell.z; z <= maxCell.z; z++)
+				{
+					auto it = cells.find(ChunkPos(x, y, z));
+					if (it != cells.end())
+						visitCell(it->second);
+				}
+			}
+		}
+	}
+
+	static int floorDiv(int value, int divisor)
+	{
+		return value >= 0 ? value / divisor : (value - divisor + 1) / divisor;
+	}
+
+	static ChunkPos getChunkPos(glm::vec3 position)
+	{
+		return ChunkPos((int)floorf(position.x / CHUNK_SIZE), (int)floorf(position.y / CHUNK_SIZE), (int)floorf(position.z / CHUNK_SIZE));
+	}
+
+	static ChunkPos getCellPos(ChunkPos chunkPos)
+	{
+		return ChunkPos(floorDiv(chunkPos.x, CELL_CHUNKS), floorDiv(chunkPos.y, CELL_CHUNKS), floorDiv(chunkPos.z, CELL_CHUNKS));
+	}
+
+	static int getSlot(ChunkPos chunkPos)
+	{
+		int x = chunkPos.x - floorDiv(chunkPos.x, CELL_CHUNKS) * CELL_CHUNKS;
+		int y = chunkPos.y - floorDiv(chunkPos.y, CELL_CHUNKS) * CELL_CHUNKS;
+		int z = chunkPos.z - floorDiv(chunkPos.z, CELL_CHUNKS) * CELL_CHUNKS;
+		return x * CELL_CHUNKS * CELL_CHUNKS + y * CELL_CHUNKS + z;
+	}
+
+private:
+	std::unordered_map<ChunkPos, Cell, ChunkPosHash> cells;
+	size_t count = 0;
+};
\ No newline at end of file
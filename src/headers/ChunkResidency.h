@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+#include "../Chunk/headers/ChunkPos.h"
+#include "../Chunk/headers/ChunkPosHash.h"
+
+// Which chunks any of several observers (players, server clients, pregeneration cursors) need, shared so that
+// overlapping observers keep a single copy of each chunk. Every chunk counts the observers whose area holds it,
+// is loaded once when the first arrives, nearest to any observer first, and released when the last one leaves.
+// Not thread safe, the owner guards it with its chunk mutex.
+class ChunkResidency
+{
+public:
+	// Observers hold every chunk within distance horizontally and height vertically of their center
+	void setRange(int distance, int height);
+
+	// Adds or moves an observer
+	void setObserver(int id, ChunkPos center);
+	void removeObserver(int id);
+
+	bool isResident(ChunkPos chunkPos) const;
+
+	// Hands out the nearest resident chunk that still needs loading, false if there is none
+	bool nextToLoad(ChunkPos& chunkPos);
+	// Called once a chunk from nextToLoad is loaded, or when a released chunk that is still loaded is observed again.
+	// False if no observer wants it anymore and it should be dropped
+	bool setLoaded(ChunkPos chunkPos);
+	// Appends the loaded chunks that lost their last observer since the last call, the owner unloads them
+	void takeReleased(std::vector<ChunkPos>& out);
+
+	bool hasPending() const;
+	unsigned int getPendingCount() const;
+	unsigned int getResidentCount() const;
+
+private:
+	enum STATE : uint8_t
+	{
+		PENDING,
+		LOADING,
+		LOADED
+	};
+
+	struct Residency
+	{
+		uint16_t observers = 0;
+		STATE state = PENDING;
+	};
+
+	// A moving observer adds its new area before removing its old one, so chunks in both are never released
+	void addArea(ChunkPos center, int distance, int height);
+	void removeArea(ChunkPos center, int distance, int height);
+	void sortPending();
+
+private:
+	int distance = 0;
+	int height = 0;
+	std::unordered_map<int, ChunkPos> observers;
+	std::unordered_map<ChunkPos, Residency, ChunkPosHash> chunks;
+	// Chunks waiting to load, nearest last, re-sorted whenever an observer moves
+	std::vector<ChunkPos> pending;
+	bool pendingSorted = true;
+	unsigned int pendingCount = 0;
+	std::vector<ChunkPos> released;
+};
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "../Chunk/headers/ChunkPos.h"
+#include "../Chunk/headers/ChunkData.h"
+#include "../Chunk/headers/ChunkPosHash.h"
+#include "ChunkResidency.h"
+#include "JobSystem.h"
+
+// Streams chunk data around the observers of a ChunkResidency on a job system, for the rendered Planet, which
+// meshes the chunks on top of it, and the headless World, which only keeps their data. The nearest chunks still
+// missing load a few per worker at a time. The data of a chunk, and of its neighbours if it is meshed against
+// them, loads in parallel, and data another loading chunk already waits on is shared instead of loaded again.
+// Once it all exists the owner's finish job completes the chunk.
+// Not thread safe, the owner guards it with the mutex it passes in, which the jobs take to publish their data.
+class ChunkStreamer
+{
+public:
+	// Loads or generates the data of a chunk, on a worker without the lock
+	typedef std::function<ChunkData*(ChunkPos)> LoadFunction;
+	// Completes a chunk once the data it needs exists, on a worker without the lock. It calls finishLoading with
+	// the lock held when done.
+	typedef std::function<void(ChunkPos)> FinishFunction;
+
+	ChunkStreamer(JobSystem& jobSystem, std::mutex& mutex, LoadFunction loadData, FinishFunction finish, bool withNeighbours, int priority);
+	// Deletes the data, the owner waits for the jobs first
+	~ChunkStreamer();
+
+	void setRange(int distance, int height);
+	void setObserver(int id, ChunkPos center);
+	void removeObserver(int id);
+
+	// Starts loading the nearest chunks that still need it. A released chunk that was observed again before the
+	// owner reclaimed or unloaded it counts as loaded instead of being loaded a second time.
+	void dispatch();
+	// Marks the chunk loaded and starts the next loads. False if no observer wants it anymore, takeReleased then
+	// hands it to the owner to unload.
+	bool finishLoading(ChunkPos chunkPos);
+	// Appends the loaded chunks that lost their last observer, the owner reclaims or unloads each
+	void takeReleased(std::vector<ChunkPos>& out);
+	// True if the released chunk was observed again, it is then marked loaded and the owner keeps it
+	bool reclaim(ChunkPos chunkPos);
+	// Forgets the chunk and deletes its data, and its neighbours' if it was loaded with them, unless a loaded or
+	// loading chunk still uses it
+	void unload(ChunkPos chunkPos);
+
+	// Data of loaded chunks and of the neighbours they were loaded with, null if there is none
+	ChunkData* getData(ChunkPos chunkPos) const;
+	const std::unordered_map<ChunkPos, ChunkData*, ChunkPosHash>& getAllData() const;
+
+	// Chunks waiting to load or loading
+	unsigned int getBacklog() const;
+
+private:
+	void startLoading(ChunkPos chunkPos);
+	const std::vector<ChunkPos>& getDataOffsets() const;
+
+public:
+	// Chunks loading at once for each job worker, so a moving observer reprioritizes quickly
+	static constexpr unsigned int CHUNKS_IN_FLIGHT_PER_THREAD = 2;
+
+private:
+	JobSystem& jobSystem;
+	std::mutex& mutex;
+	LoadFunction loadData;
+	FinishFunction finish;
+	bool withNeighbours;
+	int priority;
+
+	ChunkResidency residency;
+	std::unordered_map<ChunkPos, ChunkData*, ChunkPosHash> chunkData;
+	// Chunks that finished loading and weren't unloaded yet
+	std::unordered_set<ChunkPos, ChunkPosHash> loadedChunks;
+	// Chunks with a finish job in flight and the data jobs they wait on
+	std::unordered_set<ChunkPos, ChunkPosHash> loadingChunks;
+	std::unordered_map<ChunkPos, JobHandle, ChunkPosHash> dataJobs;
+	// Chunks that finished loading after their last observer left
+	std::vector<ChunkPos> released;
+};
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <tuple>
+#include <vector>
+#include <unordered_map>
+
+#include "TupleHash.h"
+#include "BlockAccess.h"
+
+// Flowing water driven by scheduled ticks, only cells next to a change are ever visited
+class FluidSimulation
+{
+public:
+	// Water at or past this flow level stops spreading sideways
+	static constexpr uint8_t MAX_FLOW = 7;
+	// Ticks between a change and the water next to it reacting
+	static constexpr unsigned int WATER_DELAY = 5;
+	// Slots in the timing wheel, delays must stay below this
+	static constexpr unsigned int WHEEL_SIZE = 32;
+
+	FluidSimulation(BlockAccess& world);
+
+	// Schedules the block at world (x, y, z) and its neighbours after it changed
+	void blockChanged(int x, int y, int z);
+
+	// Advances one tick and updates every cell due on it
+	void tick();
+
+private:
+	typedef std::tuple<int, int, int> BlockPos;
+
+	void schedule(BlockPos pos, unsigned int delay);
+	void scheduleNeighbors(BlockPos pos);
+	void updateCell(BlockPos pos);
+	int getFlowLevel(BlockPos pos);
+	bool setWater(BlockPos pos, uint8_t level);
+
+public:
+	// Cells updated by the last tick
+	unsigned int lastTickCells = 0;
+
+private:
+	BlockAccess& world;
+	uint64_t currentTick = 0;
+	std::vector<BlockPos> wheel[WHEEL_SIZE];
+	// Tick each cell is scheduled for, so a cell sits in the wheel at most once
+	std::unordered_map<BlockPos, uint64_t> scheduled;
+};
\ No newline at end of file
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <mutex>
+
+// GL calls only work on the render thread, so other threads queue them here and the render thread runs them
+// once a frame within a time budget. Commands run in the order they were submitted.
+class GLCommandQueue
+{
+public:
+	// Any thread
+	void submit(std::function<void()> command);
+
+	// Render thread only. Runs queued commands until budgetMilliseconds is used up, at least one if any are
+	// queued. Commands submitted meanwhile wait for the next call. Returns how many ran.
+	unsigned int execute(float budgetMilliseconds);
+
+	size_t getPendingCount();
+
+private:
+	std::mutex mutex;
+	std::deque<std::function<void()>> commands;
+};
\ No newline at end of file
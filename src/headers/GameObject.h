@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <fstream>
 #include <Graphics.h>
 #include "Camera.h"
 #include "Planet.h"
@@ -62,7 +63,10 @@ private:
     Shader fluidShader;
     Shader outlineShader;
 
+    // Target frame rate the render distance governor holds
     Slider fpsSlider;
+    // Render distance decisions, for tuning the governor per machine
+    std::ofstream metrics;
 
 };
 
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "../Chunk/headers/ChunkPos.h"
+
+// Rejects chunks behind nearer ridges for views from the terrain surface. Each chunk column is taken to be solid
+// up to its ground height, the lowest surface anywhere in it. One pass over the columns, nearest first, raises
+// the horizon of every azimuth a column spans entirely to the steepest elevation its ground could block, and
+// records for each column the lowest horizon over its azimuths from the columns wholly in front of it. A chunk
+// whose top can't rise above that is hidden. Chunks wholly under their own column's ground are left alone, as
+// they may be seen through cave mouths in the nearer columns. A tunnel right through a ridge is still not
+// accounted for and doesn't show what is behind it.
+class HorizonCuller
+{
+public:
+	static constexpr int AZIMUTH_BINS = 360;
+
+	// groundHeights holds the ground of size * size chunk columns from (startX, startZ), x-major, -INFINITY where
+	// unknown. The eye must be above the ground of its own column.
+	void build(glm::vec3 eye, int startX, int startZ, int size, const std::vector<float>& groundHeights);
+
+	// False for chunks outside the grid and chunks under their column's ground
+	bool isHidden(ChunkPos chunkPos) const;
+
+	// Checks a few known ridges and times the pass on generated terrain, false if a check failed
+	static bool runBenchmark();
+
+private:
+	struct Column
+	{
+		// Horizontal distances from the eye to the nearest and farthest points of the column
+		float nearest;
+		float farthest;
+		float ground;
+		float horizon;
+	};
+
+	glm::vec3 eye;
+	int startX = 0;
+	int startZ = 0;
+	int size = 0;
+	std::vector<Column> columns;
+	std::vector<float> horizon;
+};
\ No newline at end of file
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "WorkStealingDeque.h"
+
+// A job and the jobs waiting on it. A job runs once every dependency has finished and it was submitted.
+struct Job
+{
+	std::function<void()> work;
+	// Lower runs sooner among jobs submitted from outside the workers
+	int priority = 0;
+	// Worker the job must run on, -1 for any
+	int affinity = -1;
+	// Unfinished dependencies, plus one until the job is submitted
+	std::atomic<int> remaining{ 1 };
+
+	std::mutex mutex;
+	bool finished = false;
+	std::vector<std::shared_ptr<Job>> continuations;
+	// Keeps the job alive while it sits in a queue
+	std::shared_ptr<Job> self;
+};
+
+typedef std::shared_ptr<Job> JobHandle;
+
+// Runs a graph of jobs on a pool of worker threads. Jobs are created, given their dependencies and then
+// submitted, and start as soon as the last dependency finishes.
+// Jobs that become ready on a worker go to that worker's own deque, where it takes the newest and idle workers
+// steal the oldest. Jobs submitted from other threads go through a shared injection queue ordered by priority.
+class JobSystem
+{
+public:
+	struct Stats
+	{
+		uint64_t jobsRun = 0;
+		uint64_t steals = 0;
+		uint64_t injected = 0;
+		// Times a worker found nothing to do and went to sleep
+		uint64_t sleeps = 0;
+	};
+
+	JobSystem(unsigned int threadCount);
+	~JobSystem();
+
+	JobHandle createJob(std::function<void()> work);
+	// The job won't start before dependency finished, both must be created and job not yet submitted
+	void addDependency(const JobHandle& job, const JobHandle& dependency);
+	void submit(const JobHandle& job);
+
+	bool isFinished(const JobHandle& job);
+	// Blocks until every submitted job and everything they unlocked has finished
+	void waitIdle();
+
+	unsigned int getThreadCount() const;
+	// Index of the calling worker, -1 if it isn't one of this system's workers
+	int getWorkerIndex() const;
+	Stats getStats() const;
+
+	// Times job throughput with 1, 2, 4 ... maxThreads workers and prints the results
+	static void runBenchmark(unsigned int maxThreads);
+
+private:
+	struct Worker
+	{
+		std::thread thread;
+		WorkStealingDeque<Job> deque;
+		// Jobs with affinity for this worker
+		std::mutex mailboxMutex;
+		std::queue<Job*> mailbox;
+		std::atomic<unsigned int> mailboxSize{ 0 };
+		uint64_t seed;
+	};
+
+	struct InjectedJob
+	{
+		int priority;
+		uint64_t sequence;
+		Job* job;
+
+		bool operator<(const InjectedJob& other) const
+		{
+			// priority_queue pops the largest, so invert for lowest priority then oldest first
+			return priority != other.priority ? priority > other.priority : sequence > other.sequence;
+		}
+	};
+
+	void workerUpdate(unsigned int index);
+	Job* findJob(unsigned int index);
+	void run(Job* job);
+	void enqueue(JobHandle job);
+	void wake(bool all);
+
+private:
+	std::vector<std::unique_ptr<Worker>> workers;
+
+	std::mutex injectionMutex;
+	std::priority_queue<InjectedJob> injectionQueue;
+	uint64_t injectionSequence = 0;
+
+	// Jobs any worker could take, workers sleep while this is zero
+	std::atomic<unsigned int> queuedJobs{ 0 };
+	std::atomic<unsigned int> sleepingWorkers{ 0 };
+	std::mutex sleepMutex;
+	std::condition_variable sleepCondition;
+
+	// Submitted jobs that haven't finished yet
+	std::atomic<unsigned int> activeJobs{ 0 };
+	std::mutex idleMutex;
+	std::condition_variable idleCondition;
+
+	std::atomic<bool> shouldEnd{ false };
+
+	std::atomic<uint64_t> jobsRun{ 0 };
+	std::atomic<uint64_t> steals{ 0 };
+	std::atomic<uint64_t> injected{ 0 };
+	std::atomic<uint64_t> sleeps{ 0 };
+};
\ No newline at end of file
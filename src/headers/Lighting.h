@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "../Chunk/headers/ChunkPos.h"
+#include "../Chunk/headers/ChunkData.h"
+
+// Sky and block light, flood filled through a chunk's light array
+namespace Lighting
+{
+	constexpr int MAX_LIGHT = 15;
+
+	// Seeds sky light from the column heightmap and block light from emitting blocks, then floods both
+	void generateChunkLight(ChunkPos chunkPos, ChunkData* chunkData);
+
+	// Lights the chunk again from scratch, taking sky light from the bottom of upData (open sky when null).
+	// Returns whether the sky light leaving through the bottom changed, so the chunk below needs relighting too.
+	bool relightChunk(ChunkData* chunkData, ChunkData* upData);
+
+	// Finds the data of a loaded chunk, null where the chunk isn't loaded
+	typedef std::function<ChunkData*(ChunkPos)> ChunkDataLookup;
+
+	// Relights what a block change at local (x, y, z) of the chunk affects, the new block must already be set.
+	// Light is added and taken back across every loaded chunk it reaches, so sky light follows a shaft down into
+	// the chunks below and light spills sideways through chunk borders. The chunks whose light changed are
+	// appended to relitChunks, the edited chunk too if its own light changed.
+	// Returns how many voxels were visited.
+	unsigned int updateBlock(ChunkPos chunkPos, const ChunkDataLookup& getChunkData, int x, int y, int z,
+		std::vector<ChunkPos>& relitChunks);
+}
\ No newline at end of file
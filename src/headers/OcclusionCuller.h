@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+// Software occlusion culling on the CPU. Each frame the nearest fully opaque boxes are rasterised into a small
+// depth buffer, then chunk bounds are tested against it before they are drawn. Occluders only cover the pixels
+// they cover whole, with the farthest depth they reach inside each pixel, so a box is never reported hidden
+// while any of it could show. Rows are filled and tested four pixels at a time with SSE2 where available.
+// Doesn't use OpenGL, so it runs and is benchmarked in the headless server too.
+class OcclusionCuller
+{
+public:
+	// Depth buffer resolution, the width is a multiple of the four pixel SIMD lanes
+	static constexpr int WIDTH = 128;
+	static constexpr int HEIGHT = 64;
+	// Nearest occluders worth drawing each frame, farther ones rarely hide more than the near ones already do
+	static constexpr unsigned int MAX_OCCLUDERS = 48;
+
+	OcclusionCuller();
+
+	// Clears the depth buffer and takes the camera of the frame
+	void begin(const glm::mat4& viewProjection, glm::vec3 cameraPos);
+
+	// Draws the box into the depth buffer, every block inside it must be opaque
+	void addOccluder(glm::vec3 min, glm::vec3 max);
+
+	bool isInFrustum(glm::vec3 min, glm::vec3 max) const;
+	// True if the box is behind the occluders added so far, boxes crossing the near plane never are
+	bool isOccluded(glm::vec3 min, glm::vec3 max) const;
+
+	// Checks the culling of a few known scenes and times it on generated terrain, false if a check failed
+	static bool runBenchmark();
+
+private:
+	// Fills the pixels the convex screen space polygon covers whole, points are (x, y, depth)
+	void rasterizePolygon(const glm::vec3* points, int count);
+
+public:
+	// Occluder faces drawn since begin
+	unsigned int facesDrawn = 0;
+
+private:
+	glm::mat4 viewProjection;
+	glm::vec3 cameraPos;
+	glm::vec4 planes[6];
+	// Normalized device depth of the nearest occluder in each pixel, rows bottom to top
+	std::vector<float> depth;
+};
\ No newline at end of file
@@ -7,53 +7,130 @@
 #include <glm/glm.hpp>
 #include <thread>
 #include <mutex>
+#include <unordered_set>
 
 #include "../Chunk/headers/ChunkPos.h"
 #include "../Chunk/headers/ChunkData.h"
 #include "../Chunk/headers/Chunk.h"
 #include "./../Chunk/headers/ChunkPosHash.h"
+#include "FluidSimulation.h"
+#include "BlockAccess.h"
+#include "ChunkStreamer.h"
+#include "JobSystem.h"
+#include "GLCommandQueue.h"
+#include "RenderQueue.h"
+#include "OcclusionCuller.h"
+#include "HorizonCuller.h"
+#include "ChunkIndex.h"
+#include "RenderDistanceGovernor.h"
+#include "Lighting.h"
+#include "WorldEdit.h"
 
-constexpr unsigned int CHUNK_SIZE = 32;
-
-class Planet
+class Planet : public BlockAccess
 {
     // Methods
 public:
     Planet(Shader* solidShader, Shader* waterShader, Shader* billboardShader);
     ~Planet();
 
+    // Data of loaded chunks and of the border chunks they were meshed against, null if there is none
     ChunkData* getChunkData(ChunkPos chunkPos);
-    void update(glm::vec3 cameraPos);
+    // Loads around the camera and draws the chunks in view that the nearest solid terrain doesn't hide
+    void update(glm::vec3 cameraPos, const glm::mat4& viewProjection);
 
     Chunk* getChunk(ChunkPos chunkPos);
-    void clearChunkQueue();
+    // Finds chunk data for light updates that spread past the edited chunk
+    Lighting::ChunkDataLookup getLightLookup();
+    // Bulk edits of the ready chunks, remeshed on the chunk thread with the water next to them scheduled
+    WorldEdit::EditTarget getEditTarget();
+    // Appends the loaded chunks overlapping the box of world positions, for physics and tools that touch an area
+    void getChunksInBox(glm::vec3 min, glm::vec3 max, std::vector<Chunk*>& out);
+
+    // Keeps the chunks around position loaded for viewpoints other than the camera, such as pregeneration
+    // cursors. Chunks are shared between all observers and generated once however many overlap.
+    void setObserver(int id, glm::vec3 position);
+    void removeObserver(int id);
+
+    // World position block access for ready chunks, false if the chunk is not loaded
+    bool getBlock(int x, int y, int z, uint16_t& block) override;
+    // Sets and relights the block, the chunk is remeshed once at the end of the tick
+    bool setBlock(int x, int y, int z, uint16_t block) override;
+    uint8_t getFlowLevel(int x, int y, int z) override;
+    bool setFlowLevel(int x, int y, int z, uint8_t level) override;
+
+    // Rebuilds the chunk's mesh on the chunk thread, it is uploaded on the next render
+    void queueRemesh(ChunkPos chunkPos);
+
+    // Runs the world ticks that fit in deltaTime milliseconds
+    void updateTicks(float deltaTime);
+
+    // Feeds the frame time and the load backlog to the render distance governor and applies its distance
+    void updateRenderDistance(float frameTime);
 
 private:
-    void chunkThreadUpdate();
+    void queueChunk(Chunk* chunk, glm::vec3 cameraPos, bool horizonCulling);
+    void addOccluders(glm::vec3 cameraPos);
+    bool buildHorizon(glm::vec3 cameraPos);
+    void dispatchChunkJobs();
+    void finishChunk(ChunkPos chunkPos);
+    void unloadReleasedChunks();
+    void queueUpload(Chunk* chunk);
+    void randomTick();
+    void remeshDirtyChunks();
 
     // Variables
 public:
     static Planet* planet;
-    unsigned int numChunks = 0, numChunksRendered = 0;
+    // Observer id update uses for the camera
+    static constexpr int CAMERA_OBSERVER = 0;
+    // Edits show up before new chunks load in
+    static constexpr int REMESH_PRIORITY = 0;
+    static constexpr int LOAD_PRIORITY = 1;
+    // Milliseconds a frame may spend on queued uploads and deletions
+    static constexpr float GL_COMMAND_BUDGET = 2.0f;
+    // Range the render distance governor may pick from and the memory the chunk data may take
+    static constexpr int MIN_RENDER_DISTANCE = 2;
+    static constexpr int MAX_RENDER_DISTANCE = 16;
+    static constexpr size_t CHUNK_MEMORY_BUDGET = 1024ull * 1024 * 1024;
+    // Occluders are picked among the chunks this many blocks from the camera
+    static constexpr float OCCLUDER_RADIUS = 4.0f * CHUNK_SIZE;
+    unsigned int numChunks = 0, numChunksRendered = 0, numChunksOccluded = 0, numChunksBelowHorizon = 0;
+    // Cells of the chunk index rejected whole by frustum or occlusion culling
+    unsigned int numCellsCulled = 0;
+    // Voxels the last block edit relit
+    unsigned int lightUpdateVoxels = 0;
+    // GL work other threads queue for the render thread
+    GLCommandQueue glCommands;
+    unsigned int glCommandsExecuted = 0;
+    RenderQueue renderQueue;
+    OcclusionCuller occlusionCuller;
+    HorizonCuller horizonCuller;
+    FluidSimulation fluidSimulation;
+    // Set by the governor every frame, only the height is fixed
     int renderDistance = 5;
     int renderHeight = 3;
+    // Chunks out to which plants are drawn, thinning out over the second half
+    int billboardDistance = 4;
+    RenderDistanceGovernor renderDistanceGovernor;
 
 private:
-    std::unordered_map<ChunkPos, Chunk*, ChunkPosHash> chunks;
-    std::unordered_map<ChunkPos, ChunkData*, ChunkPosHash> chunkData;
-    std::queue<ChunkPos> chunkQueue;
-    std::queue<ChunkPos> chunkDataQueue;
-    std::queue<ChunkPos> chunkDataDeleteQueue;
-    unsigned int chunksLoading = 0;
-    int lastCamX = -100, lastCamY = -100, lastCamZ = -100;
-    int camChunkX = -100, camChunkY = -100, camChunkZ = -100;
+    ChunkIndex<Chunk*> chunks;
+    // Released chunks waiting for their remesh to finish before they are deleted
+    std::vector<ChunkPos> unloadQueue;
+    std::queue<ChunkPos> remeshQueue;
+    std::unordered_set<ChunkPos, ChunkPosHash> dirtyChunks;
+    // Ready chunks with a solid slab and their squared distance, rebuilt every frame
+    std::vector<std::pair<float, Chunk*>> occluders;
+    // Ground of the chunk columns around the camera, x-major, rebuilt every frame
+    std::vector<float> groundHeights;
+    float tickTime = 0.0f;
 
     Shader* solidShader;
     Shader* waterShader;
     Shader* billboardShader;
 
-    std::thread chunkThread;
     std::mutex chunkMutex;
-
-    bool shouldEnd = false;
+    // Loads the chunk data, finishChunk meshes each chunk against its neighbours
+    ChunkStreamer streamer;
+    JobSystem jobSystem;
 };
\ No newline at end of file
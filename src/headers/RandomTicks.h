@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include "BlockAccess.h"
+#include "../Chunk/headers/ChunkData.h"
+
+// Slow block changes (grass spreading, leaf decay, plant growth) driven by randomly sampled voxels
+namespace RandomTicks
+{
+	// Voxels sampled in each 32x8x32 section per tick
+	constexpr int TICKS_PER_SECTION = 3;
+
+	// Leaves further than this from a log decay
+	constexpr int LEAF_DECAY_DISTANCE = 4;
+
+	// Whether random ticks do anything to this block
+	bool isTickable(uint16_t block);
+
+	// Samples every section of the chunk that holds tickable blocks
+	void tickChunk(BlockAccess& world, ChunkPos chunkPos, ChunkData* chunkData);
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+
+// Picks the render distance that holds a target frame rate. Frames are averaged over half second windows.
+// A slow window lowers the distance at once if chunk memory is over budget, otherwise after a second slow
+// window. A fast window only counts towards raising it if loading has caught up and the larger area would fit
+// the memory budget. Several fast windows in a row are needed to raise it. Windows in between reset both counts.
+// A distance that was lowered for frame time is not tried again for a while, so it doesn't keep flip-flopping
+// at the edge of what the machine can draw. Every change is written to the metrics stream, if there is one.
+class RenderDistanceGovernor
+{
+public:
+	RenderDistanceGovernor(int minDistance, int maxDistance, int distance);
+
+	void setTargetFps(float fps);
+	void setMemoryBudget(size_t bytes);
+
+	// Feeds one frame of frameTime milliseconds along with the chunks still waiting to load, mesh or upload and
+	// the memory the loaded chunks use. Returns true if the distance changed.
+	bool update(float frameTime, unsigned int backlog, size_t memoryBytes);
+
+	int getDistance() const;
+	// Average frame time of the last full window
+	float getAverageFrameTime() const;
+
+	// Runs the governor against a simulated machine, false if a check failed
+	static bool runCheck();
+
+private:
+	void evaluate(unsigned int backlog, size_t memoryBytes);
+	void setDistance(int newDistance, const char* reason, unsigned int backlog, size_t memoryBytes);
+
+public:
+	// Milliseconds of frames averaged before each decision
+	static constexpr float WINDOW_LENGTH = 500.0f;
+	// Windows slower than target * SLOW_FACTOR lower the distance, faster than target * FAST_FACTOR raise it
+	static constexpr float SLOW_FACTOR = 1.1f;
+	static constexpr float FAST_FACTOR = 0.75f;
+	static constexpr int LOWER_WINDOWS = 2;
+	static constexpr int RAISE_WINDOWS = 6;
+	// Windows a distance that was too slow stays off limits
+	static constexpr int RETRY_WINDOWS = 60;
+	// Most chunks that may still be waiting for the distance to be raised
+	static constexpr unsigned int MAX_RAISE_BACKLOG = 16;
+
+	// Where decisions are written, one line each
+	std::ostream* metrics = nullptr;
+
+private:
+	int minDistance;
+	int maxDistance;
+	int distance;
+	float targetFrameTime = 1000.0f / 60.0f;
+	size_t memoryBudget = 1024ull * 1024 * 1024;
+
+	float windowTime = 0.0f;
+	unsigned int windowFrames = 0;
+	float averageFrameTime = 0.0f;
+	// Time since the governor started, for the metrics
+	double totalTime = 0.0;
+
+	int slowWindows = 0;
+	int fastWindows = 0;
+	// Distance that was last lowered from for frame time and the windows until it may be tried again
+	int failedDistance = 0;
+	int retryWindows = 0;
+};
\ No newline at end of file
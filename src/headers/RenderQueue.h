@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <glm/glm.hpp>
+#include <Shader.h>
+
+enum RENDER_PASS
+{
+	SOLID_PASS,
+	BILLBOARD_PASS,
+	WATER_PASS
+};
+
+// Collects the frame's draws from every chunk and issues them sorted by pass, then shader, then vertex array,
+// so each pass sets its GL state once and each shader is bound once per pass. Water is drawn back to front
+// instead so blending comes out right. Chunks are placed with a chunkOffset uniform instead of a model matrix.
+class RenderQueue
+{
+public:
+	// Draws indexCount indices from firstIndex on. distance is any measure of distance from the camera, such as squared distance
+	void add(RENDER_PASS pass, Shader* shader, unsigned int vertexArray, unsigned int firstIndex, unsigned int indexCount, glm::vec3 offset, float distance);
+	// Draws the first indexCount indices instanceCount times, the vertex array supplies the per-instance attributes
+	void addInstanced(RENDER_PASS pass, Shader* shader, unsigned int vertexArray, unsigned int indexCount, unsigned int instanceCount, glm::vec3 offset, float distance);
+
+	// Draws and clears the queued items, leaving blending and face culling enabled
+	void draw();
+
+private:
+	struct DrawItem
+	{
+		RENDER_PASS pass;
+		Shader* shader;
+		unsigned int vertexArray;
+		unsigned int firstIndex;
+		unsigned int indexCount;
+		// 0 for a plain draw
+		unsigned int instanceCount;
+		glm::vec3 offset;
+		float distance;
+	};
+
+	void beginPass(RENDER_PASS pass);
+	int getOffsetLocation(unsigned int program);
+
+public:
+	// Counts of the last draw
+	unsigned int drawCalls = 0;
+	unsigned int trianglesDrawn = 0;
+	// Shader binds and pass state changes
+	unsigned int stateChanges = 0;
+
+private:
+	std::vector<DrawItem> items;
+	std::unordered_map<unsigned int, int> offsetLocations;
+};
\ No newline at end of file
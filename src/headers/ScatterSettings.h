@@ -0,0 +1,11 @@
+#pragma once
+
+struct ScatterSettings
+{
+  int cellSize;
+  int spacing;
+  float chance;
+  unsigned int seed;
+  ScatterSettings(int _cellSize, int _spacing, float _chance, unsigned int _seed);
+  ~ScatterSettings();
+};
\ No newline at end of file
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Chase-Lev work-stealing deque (with the memory orderings of Le et al. 2013). The owning thread pushes and
+// pops at the bottom without locking, any other thread steals from the top. Grows when full; old buffers
+// are kept until the deque is destroyed since a thief may still be reading one.
+template <typename T>
+class WorkStealingDeque
+{
+public:
+	WorkStealingDeque(int64_t capacity = 256)
+	{
+		buffers.emplace_back(new Buffer(capacity));
+		buffer.store(buffers.back().get(), std::memory_order_relaxed);
+	}
+
+	WorkStealingDeque(const WorkStealingDeque&) = delete;
+	WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+	// Owner only
+	void push(T* item)
+	{
+		int64_t b = bottom.load(std::memory_order_relaxed);
+		int64_t t = top.load(std::memory_order_acquire);
+		Buffer* a = buffer.load(std::memory_order_relaxed);
+		if (b - t > a->capacity - 1)
+			a = grow(a, t, b);
+
+		a->put(b, item);
+		std::atomic_thread_fence(std::memory_order_release);
+		bottom.store(b + 1, std::memory_order_relaxed);
+	}
+
+	// Owner only, newest item first, null if empty
+	T* pop()
+	{
+		int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+		Buffer* a = buffer.load(std::memory_order_relaxed);
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t t = top.load(std::memory_order_relaxed);
+
+		T* item = nullptr;
+		if (t <= b)
+		{
+			item = a->get(b);
+			if (t == b)
+			{
+				// Last item, race thieves for it
+				if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+					item = nullptr;
+				bottom.store(b + 1, std::memory_order_relaxed);
+			}
+		}
+		else
+		{
+			bottom.store(b + 1, std::memory_order_relaxed);
+		}
+		return item;
+	}
+
+	// Any thread, oldest item first, null if empty or another thread won the race
+	T* steal()
+	{
+		int64_t t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t b = bottom.load(std::memory_order_acquire);
+
+		if (t >= b)
+			return nullptr;
+
+		Buffer* a = buffer.load(std::memory_order_acquire);
+		T* item = a->get(t);
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			return nullptr;
+		return item;
+	}
+
+	bool empty() const
+	{
+		return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+	}
+
+private:
+	struct Buffer
+	{
+		int64_t capacity;
+		std::unique_ptr<std::atomic<T*>[]> items;
+
+		Buffer(int64_t capacity)
+			: capacity(capacity), items(new std::atomic<T*>[capacity])
+		{
+
+		}
+
+		T* get(int64_t index) const
+		{
+			return items[index & (capacity - 1)].load(std::memory_order_relaxed);
+		}
+
+		void put(int64_t index, T* item)
+		{
+			items[index & (capacity - 1)].store(item, std::memory_order_relaxed);
+		}
+	};
+
+	Buffer* grow(Buffer* old, int64_t t, int64_t b)
+	{
+		buffers.emplace_back(new Buffer(old->capacity * 2));
+		Buffer* a = buffers.back().get();
+		for (int64_t i = t; i < b; i++)
+			a->put(i, old->get(i));
+		buffer.store(a, std::memory_order_release);
+		return a;
+	}
+
+private:
+	std::atomic<int64_t> top{ 0 };
+	std::atomic<int64_t> bottom{ 0 };
+	std::atomic<Buffer*> buffer;
+	// Every buffer ever used, only the owner touches this
+	std::vector<std::unique_ptr<Buffer>> buffers;
+};
\ No newline at end of file
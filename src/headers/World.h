@@ -0,0 +1,81 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <string>
+#include <glm/glm.hpp>
+#include <mutex>
+
+#include "../Chunk/headers/ChunkPos.h"
+#include "../Chunk/headers/ChunkData.h"
+#include "../Chunk/headers/ChunkPosHash.h"
+#include "BlockAccess.h"
+#include "ChunkStreamer.h"
+#include "FluidSimulation.h"
+#include "JobSystem.h"
+
+// A block set in a loaded chunk, index is into ChunkData::data
+struct BlockChange
+{
+    ChunkPos chunkPos;
+    uint16_t index;
+    uint16_t block;
+};
+
+// The simulated world without rendering, for the headless server. Streams chunk data around any number of
+// interest centers with the same ChunkStreamer the Planet uses, runs the world ticks and saves edited chunks.
+// Chunk data is only unloaded on the thread that calls setInterestCenters and tick, so block access there is safe.
+class World : public BlockAccess
+{
+    // Methods
+public:
+    World(const std::string& saveDirectory);
+    ~World();
+
+    // Chunks within renderDistance (renderHeight vertically) of any of the positions stay loaded, the rest are
+    // saved if edited and unloaded. Chunks load nearest to any position first and only once however many overlap.
+    void setInterestCenters(const std::vector<glm::vec3>& positions);
+
+    bool getBlock(int x, int y, int z, uint16_t& block) override;
+    bool setBlock(int x, int y, int z, uint16_t block) override;
+    uint8_t getFlowLevel(int x, int y, int z) override;
+    bool setFlowLevel(int x, int y, int z, uint8_t level) override;
+    // A change from outside the simulation, such as a player, which also wakes the water around it
+    bool editBlock(int x, int y, int z, uint16_t block);
+
+    void tick();
+
+    // Writes every edited chunk to the save directory
+    void save();
+
+    // Loaded chunk data or null, only valid until the next setInterestCenters call
+    ChunkData* getChunkData(ChunkPos chunkPos);
+
+    unsigned int getLoadedChunkCount();
+    unsigned int getQueuedChunkCount();
+
+private:
+    ChunkData* loadChunkData(ChunkPos chunkPos);
+    void saveChunkData(ChunkPos chunkPos, ChunkData* data);
+    std::string getChunkPath(ChunkPos chunkPos) const;
+
+    // Variables
+public:
+    int renderDistance = 5;
+    int renderHeight = 3;
+    FluidSimulation fluidSimulation;
+    uint64_t tickCount = 0;
+    // Every block set since whoever consumes the changes last cleared this, in order
+    std::vector<BlockChange> blockChanges;
+
+private:
+    std::string saveDirectory;
+    // Loaded chunks that differ from what is on disk
+    std::unordered_set<ChunkPos, ChunkPosHash> editedChunks;
+    size_t interestCenterCount = 0;
+
+    std::mutex chunkMutex;
+    ChunkStreamer streamer;
+    JobSystem jobSystem;
+};
\ No newline at end of file
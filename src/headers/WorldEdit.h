@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "../Chunk/headers/ChunkPos.h"
+#include "../Chunk/headers/ChunkData.h"
+
+// Bulk block edits over boxes and schematics. Each edit writes the loaded chunks chunk by chunk,
+// relights every touched chunk once and queues one remesh per affected chunk on the chunk thread.
+namespace WorldEdit
+{
+	// Where an edit finds chunk data and sends finished chunks, the planet has one and the benchmark makes its own
+	struct EditTarget
+	{
+		// Null for chunks that aren't loaded
+		std::function<ChunkData*(ChunkPos)> getChunkData;
+		// Appends the loaded chunks overlapping the box of blocks in one index query, an edit looks its chunks up here
+		// instead of calling getChunkData for each
+		std::function<void(glm::ivec3, glm::ivec3, std::vector<std::pair<ChunkPos, ChunkData*>>&)> getChunksInBox;
+		std::function<void(ChunkPos)> remesh;
+		// Called for the blocks on the faces of an edited box, so water next to it reacts
+		std::function<void(int, int, int)> blockChanged;
+	};
+
+	// A block of blocks indexed like SurfaceFeature, y * sizeX * sizeZ + x * sizeZ + z
+	struct Schematic
+	{
+		int sizeX, sizeY, sizeZ;
+		std::vector<uint16_t> blocks;
+	};
+
+	struct EditStats
+	{
+		unsigned int chunksEdited = 0;
+		// Chunks that were not loaded, their part of the edit is dropped
+		unsigned int chunksSkipped = 0;
+		unsigned int chunksRelit = 0;
+		unsigned int chunksRemeshed = 0;
+		uint64_t blocksChanged = 0;
+		double editMilliseconds = 0.0;
+		double relightMilliseconds = 0.0;
+	};
+
+	// Boxes include both corners
+	EditStats fill(const EditTarget& target, glm::ivec3 min, glm::ivec3 max, uint16_t block);
+	EditStats replace(const EditTarget& target, glm::ivec3 min, glm::ivec3 max, uint16_t fromBlock, uint16_t toBlock);
+	// Pastes with the schematic's lowest corner at position, air in the schematic is skipped unless pasteAir is set
+	EditStats paste(const EditTarget& target, const Schematic& schematic, glm::ivec3 position, bool pasteAir);
+	// Copies the loaded blocks of the box, unloaded blocks come out as air
+	Schematic copy(const EditTarget& target, glm::ivec3 min, glm::ivec3 max);
+
+	// Fills and replaces a boxSize^3 box of detached chunks and prints the timings
+	void runBenchmark(int boxSize);
+}
\ No newline at end of file
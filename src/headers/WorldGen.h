@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
 #include <vector>
 #include "NoiseSettings.h"
 #include "SurfaceFeature.h"
@@ -7,5 +9,29 @@
 
 namespace WorldGen
 {
+	// A surface feature anchored at a world position (the column's surface height)
+	struct FeaturePlacement
+	{
+		int featureId;
+		int x, y, z;
+	};
+
+	// Regions are square columns of chunks that share one feature placement pass
+	constexpr int REGION_SIZE = 4;
+
 	void generateChunkData(ChunkPos chunkPos, uint16_t* chunkData);
+
+	// Returns the cached feature placements of a region, computing them on first use
+	std::shared_ptr<const std::vector<FeaturePlacement>> getRegionFeatures(int regionX, int regionZ);
+
+	// Surface height of the column at world (x, z), the same value generateChunkData builds terrain from
+	int surfaceHeight(int x, int z);
+	// Dominant biome of the column at world (x, z), an index into Biomes::biomes
+	int surfaceBiome(int x, int z);
+
+	// Surface heights of the columns in [startX, startX + sizeX) x [startZ, startZ + sizeZ), x-major
+	void surfaceHeights(int startX, int startZ, int sizeX, int sizeZ, int* heights);
+
+	// Drops every cached region, later chunks rebuild them on demand
+	void clearRegionCache();
 }
\ No newline at end of file
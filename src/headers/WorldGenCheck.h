@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+#include "../Chunk/headers/ChunkPos.h"
+
+// Guards world generation against silent changes by comparing chunk fingerprints with known values.
+// When generation is changed on purpose, run the check and paste the printed fingerprints into the golden table.
+namespace WorldGenCheck
+{
+	// FNV-1a over the block ids of a chunk
+	uint64_t fingerprint(const uint16_t* chunkData);
+
+	// Generates every golden chunk with threadCount workers (0 = on the calling thread) and compares the results.
+	// Prints each mismatch and returns whether all chunks matched.
+	bool run(unsigned int threadCount);
+}
\ No newline at end of file